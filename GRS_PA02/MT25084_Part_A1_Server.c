@@ -1,6 +1,9 @@
 // MT25084_Part_A1_Server.c
 // A1: Multi-client server (one thread per client), normal send()
-// Usage: ./MT25084_Part_A1_Server <port> <msg_size> <duration_sec> <num_clients>
+// Usage: ./MT25084_Part_A1_Server <port> <msg_size> <duration_sec> <num_clients> [--busy-poll[=usec]]
+//        [--dist=<spec>] [--seed=<n>]   (see MT25084_Part_A_Dist.h; msg_size is then the max size)
+//        [--tcpinfo[=ms]] [--sndbuf=<bytes>] [--rcvbuf=<bytes>] [--steer-cpu]
+//        [--lowmem[=stack_kib]]   (small worker stacks + one shared payload, see MT25084_Part_A_MemAcct.h)
 
 #define _GNU_SOURCE
 #include <arpa/inet.h>
@@ -15,11 +18,20 @@
 #include <time.h>
 #include <unistd.h>
 
+#include "MT25084_Part_A_BusyPoll.h"
+#include "MT25084_Part_A_CpuSteer.h"
+#include "MT25084_Part_A_Dist.h"
+#include "MT25084_Part_A_MemAcct.h"
+#include "MT25084_Part_A_SockBuf.h"
+#include "MT25084_Part_A_TcpInfo.h"
+
 typedef struct {
     int fd;
-    int msg_size;
     int duration;
     struct timespec start_ts;
+    int io_flags; // MSG_DONTWAIT in busy-poll mode
+    const msg_dist_t *dist; // shared, read-only size table
+    mem_acct_t *mem;        // payload source (one shared buffer with --lowmem)
 } worker_arg_t;
 
 static double now_sec_monotonic(void) {
@@ -31,30 +43,32 @@ static double now_sec_monotonic(void) {
 static void *client_worker(void *vp) {
     worker_arg_t *arg = (worker_arg_t *)vp;
     int fd = arg->fd;
-    int msg_size = arg->msg_size;
     int duration = arg->duration;
+    int io_flags = arg->io_flags;
+    const msg_dist_t *dist = arg->dist;
+    unsigned cursor = 0;
 
     double t0 = (double)arg->start_ts.tv_sec + (double)arg->start_ts.tv_nsec / 1e9;
 
-    char *buf = (char *)malloc((size_t)msg_size);
+    char *buf = mem_payload_get(arg->mem);
     if (!buf) {
-        perror("malloc");
         close(fd);
         free(arg);
         return NULL;
     }
-    memset(buf, 'A', (size_t)msg_size);
 
     // avoid SIGPIPE crash if peer closes
     signal(SIGPIPE, SIG_IGN);
 
     while (now_sec_monotonic() - t0 < (double)duration) {
+        int len = dist_next(dist, &cursor);
         ssize_t sent = 0;
-        while (sent < msg_size) {
-            ssize_t n = send(fd, buf + sent, (size_t)(msg_size - sent), 0);
+        while (sent < len) {
+            ssize_t n = send(fd, buf + sent, (size_t)(len - sent), io_flags);
             if (n > 0) { sent += n; continue; }
             if (n == 0) goto done;
             if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) continue; // busy-poll spin
             goto done;
         }
     }
@@ -62,14 +76,14 @@ static void *client_worker(void *vp) {
 done:
     shutdown(fd, SHUT_RDWR);
     close(fd);
-    free(buf);
+    mem_payload_put(arg->mem, buf);
     free(arg);
     return NULL;
 }
 
 int main(int argc, char **argv) {
     if (argc < 5) {
-        fprintf(stderr, "Usage: %s <port> <msg_size> <duration_sec> <num_clients>\n", argv[0]);
+        fprintf(stderr, "Usage: %s <port> <msg_size> <duration_sec> <num_clients> [--busy-poll[=usec]] [--dist=<spec>] [--seed=<n>] [--tcpinfo[=ms]] [--sndbuf=<bytes>] [--rcvbuf=<bytes>] [--steer-cpu] [--lowmem[=stack_kib]]\n", argv[0]);
         return 1;
     }
 
@@ -83,8 +97,28 @@ int main(int argc, char **argv) {
         return 1;
     }
 
+    busy_poll_cfg_t bp = {0};
+    msg_dist_t dist = {0};
+    tcpinfo_sampler_t ti = {0};
+    sockbuf_cfg_t sb = {0};
+    cpu_steer_cfg_t cs = {0};
+    mem_acct_t mem = {0};
+    for (int i = 5; i < argc; i++) {
+        if (busy_poll_parse_opt(argv[i], &bp) == 1) continue;
+        if (dist_parse_opt(argv[i], &dist) == 1) continue;
+        if (tcpinfo_parse_opt(argv[i], &ti) == 1) continue;
+        if (sockbuf_parse_opt(argv[i], &sb) == 1) continue;
+        if (cpu_steer_parse_opt(argv[i], &cs) == 1) continue;
+        if (mem_acct_parse_opt(argv[i], &mem) == 1) continue;
+        fprintf(stderr, "Unknown option: %s\n", argv[i]);
+        return 1;
+    }
+    if (dist_build(&dist, msg_size) < 0) return 1;
+    tcpinfo_start(&ti, "srv");
+
     int sfd = socket(AF_INET, SOCK_STREAM, 0);
     if (sfd < 0) { perror("socket"); return 1; }
+    sockbuf_apply(sfd, &sb);
 
     int opt = 1;
     setsockopt(sfd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
@@ -107,10 +141,15 @@ int main(int argc, char **argv) {
         return 1;
     }
 
-    printf("[A1 Server] listening on port %d | msg_size=%d | duration=%ds | clients=%d\n",
-           port, msg_size, duration, num_clients);
+    printf("[A1 Server] listening on port %d | msg_size=%d | duration=%ds | clients=%d | busy_poll=%d | dist=%s mean=%.1f\n",
+           port, msg_size, duration, num_clients, bp.enabled ? bp.usec : 0, dist.spec, dist.mean_size);
     fflush(stdout);
 
+    if (mem_acct_init(&mem, msg_size, 'A', num_clients) < 0) {
+        close(sfd);
+        return 1;
+    }
+
     pthread_t *tids = calloc((size_t)num_clients, sizeof(pthread_t));
     if (!tids) { perror("calloc"); close(sfd); return 1; }
 
@@ -131,6 +170,10 @@ int main(int argc, char **argv) {
             goto join_and_exit;
         }
 
+        busy_poll_apply(cfd, &bp);
+        tcpinfo_add(&ti, cfd);
+        mem_acct_add(&mem, cfd);
+
         worker_arg_t *arg = malloc(sizeof(*arg));
         if (!arg) {
             perror("malloc");
@@ -140,11 +183,17 @@ int main(int argc, char **argv) {
         }
 
         arg->fd = cfd;
-        arg->msg_size = msg_size;
         arg->duration = duration;
         arg->start_ts = start_ts;
-
-        int rc = pthread_create(&tids[i], NULL, client_worker, arg);
+        arg->io_flags = busy_poll_io_flags(&bp);
+        arg->dist = &dist;
+        arg->mem = &mem;
+
+        pthread_attr_t attr;
+        int steered = cpu_steer_worker_attr(&cs, cfd, &attr);
+        int custom = mem_worker_attr(&mem, &attr, steered);
+        int rc = pthread_create(&tids[i], custom ? &attr : NULL, client_worker, arg);
+        if (custom) pthread_attr_destroy(&attr);
         if (rc != 0) {
             fprintf(stderr, "pthread_create: %s\n", strerror(rc));
             close(cfd);
@@ -156,10 +205,16 @@ int main(int argc, char **argv) {
 
 join_and_exit:
     close(sfd);
+    mem_acct_sample(&mem, &start_ts, duration, tids, num_clients);
 
     for (int i = 0; i < num_clients; i++) {
         if (tids[i]) pthread_join(tids[i], NULL);
     }
     free(tids);
+    dist_free(&dist);
+    tcpinfo_stop(&ti);
+
+    mem_acct_report(&mem);
+    printf("SERVER_SUMMARY cpu_s=%.6f busy_poll=%d\n", cpu_sec_self(), bp.enabled ? bp.usec : 0);
     return 0;
 }
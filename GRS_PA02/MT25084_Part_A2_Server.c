@@ -1,6 +1,9 @@
 // MT25084_Part_A2_Server.c
 // A2: Multi-client server (one thread per client)
-// Usage: ./MT25084_Part_A2_Server <port> <msg_size> <duration_sec> <num_clients>
+// Usage: ./MT25084_Part_A2_Server <port> <msg_size> <duration_sec> <num_clients> [--busy-poll[=usec]]
+//        [--dist=<spec>] [--seed=<n>]   (see MT25084_Part_A_Dist.h; msg_size is then the max size)
+//        [--tcpinfo[=ms]] [--sndbuf=<bytes>] [--rcvbuf=<bytes>] [--steer-cpu]
+//        [--lowmem[=stack_kib]]   (small worker stacks + one shared payload, see MT25084_Part_A_MemAcct.h)
 // Example: ./MT25084_Part_A2_Server 9090 1024 20 4
 
 #define _GNU_SOURCE
@@ -18,11 +21,20 @@
 #include <time.h>
 #include <unistd.h>
 
+#include "MT25084_Part_A_BusyPoll.h"
+#include "MT25084_Part_A_CpuSteer.h"
+#include "MT25084_Part_A_Dist.h"
+#include "MT25084_Part_A_MemAcct.h"
+#include "MT25084_Part_A_SockBuf.h"
+#include "MT25084_Part_A_TcpInfo.h"
+
 typedef struct {
     int fd;
-    int msg_size;
     int duration;
     struct timespec start_ts;
+    int io_flags; // MSG_DONTWAIT in busy-poll mode
+    const msg_dist_t *dist; // shared, read-only size table
+    mem_acct_t *mem;        // payload source (one shared buffer with --lowmem)
 } worker_arg_t;
 
 static double now_sec_monotonic(void) {
@@ -34,27 +46,29 @@ static double now_sec_monotonic(void) {
 static void *client_worker(void *vp) {
     worker_arg_t *arg = (worker_arg_t *)vp;
     int fd = arg->fd;
-    int msg_size = arg->msg_size;
     int duration = arg->duration;
+    int io_flags = arg->io_flags;
+    const msg_dist_t *dist = arg->dist;
+    unsigned cursor = 0;
     double t0 = (double)arg->start_ts.tv_sec + (double)arg->start_ts.tv_nsec / 1e9;
 
-    // allocate a buffer and keep sending payload to the connected client
-    char *buf = (char *)malloc((size_t)msg_size);
+    // payload to keep sending to the connected client
+    char *buf = mem_payload_get(arg->mem);
     if (!buf) {
-        perror("malloc");
         close(fd);
         free(arg);
         return NULL;
     }
-    memset(buf, 'A', (size_t)msg_size);
 
     // reduce chances of SIGPIPE killing thread if client closes
     signal(SIGPIPE, SIG_IGN);
 
     while (now_sec_monotonic() - t0 < (double)duration) {
+        // next message size from the pre-generated table (msg_size when fixed)
+        int len = dist_next(dist, &cursor);
         ssize_t sent = 0;
-        while (sent < msg_size) {
-            ssize_t n = send(fd, buf + sent, (size_t)(msg_size - sent), 0);
+        while (sent < len) {
+            ssize_t n = send(fd, buf + sent, (size_t)(len - sent), io_flags);
             if (n > 0) {
                 sent += n;
                 continue;
@@ -65,6 +79,10 @@ static void *client_worker(void *vp) {
             }
             if (errno == EINTR)
                 continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // busy-poll mode: socket buffer full, spin instead of sleeping
+                continue;
+            }
             // EPIPE/ECONNRESET etc => client went away
             goto done;
         }
@@ -73,7 +91,7 @@ static void *client_worker(void *vp) {
 done:
     shutdown(fd, SHUT_RDWR);
     close(fd);
-    free(buf);
+    mem_payload_put(arg->mem, buf);
     free(arg);
     return NULL;
 }
@@ -81,7 +99,7 @@ done:
 int main(int argc, char **argv) {
     if (argc < 5) {
         fprintf(stderr,
-                "Usage: %s <port> <msg_size> <duration_sec> <num_clients>\n",
+                "Usage: %s <port> <msg_size> <duration_sec> <num_clients> [--busy-poll[=usec]] [--dist=<spec>] [--seed=<n>] [--tcpinfo[=ms]] [--sndbuf=<bytes>] [--rcvbuf=<bytes>] [--steer-cpu] [--lowmem[=stack_kib]]\n",
                 argv[0]);
         return 1;
     }
@@ -96,11 +114,43 @@ int main(int argc, char **argv) {
         return 1;
     }
 
+    // optional trailing flags
+    busy_poll_cfg_t bp = {0};
+    msg_dist_t dist = {0};
+    tcpinfo_sampler_t ti = {0};
+    sockbuf_cfg_t sb = {0};
+    cpu_steer_cfg_t cs = {0};
+    mem_acct_t mem = {0};
+    for (int i = 5; i < argc; i++) {
+        if (busy_poll_parse_opt(argv[i], &bp) == 1)
+            continue;
+        if (dist_parse_opt(argv[i], &dist) == 1)
+            continue;
+        if (tcpinfo_parse_opt(argv[i], &ti) == 1)
+            continue;
+        if (sockbuf_parse_opt(argv[i], &sb) == 1)
+            continue;
+        if (cpu_steer_parse_opt(argv[i], &cs) == 1)
+            continue;
+        if (mem_acct_parse_opt(argv[i], &mem) == 1)
+            continue;
+        fprintf(stderr, "Unknown option: %s\n", argv[i]);
+        return 1;
+    }
+
+    // pre-generate the size table once; workers only index into it
+    if (dist_build(&dist, msg_size) < 0)
+        return 1;
+
+    // transport telemetry side thread (no-op without --tcpinfo)
+    tcpinfo_start(&ti, "srv");
+
     int sfd = socket(AF_INET, SOCK_STREAM, 0);
     if (sfd < 0) {
         perror("socket");
         return 1;
     }
+    sockbuf_apply(sfd, &sb);
 
     int opt = 1;
     if (setsockopt(sfd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
@@ -128,10 +178,15 @@ int main(int argc, char **argv) {
         return 1;
     }
 
-    printf("[A2 Server] listening on port %d | msg_size=%d | duration=%ds | clients=%d\n",
-           port, msg_size, duration, num_clients);
+    printf("[A2 Server] listening on port %d | msg_size=%d | duration=%ds | clients=%d | busy_poll=%d | dist=%s mean=%.1f\n",
+           port, msg_size, duration, num_clients, bp.enabled ? bp.usec : 0, dist.spec, dist.mean_size);
     fflush(stdout);
 
+    if (mem_acct_init(&mem, msg_size, 'A', num_clients) < 0) {
+        close(sfd);
+        return 1;
+    }
+
     pthread_t *tids = (pthread_t *)calloc((size_t)num_clients, sizeof(pthread_t));
     if (!tids) {
         perror("calloc");
@@ -161,6 +216,10 @@ int main(int argc, char **argv) {
             goto join_and_exit;
         }
 
+        busy_poll_apply(cfd, &bp);
+        tcpinfo_add(&ti, cfd);
+        mem_acct_add(&mem, cfd);
+
         // IMPORTANT: per-thread heap arg (no &cfd bug)
         worker_arg_t *arg = (worker_arg_t *)malloc(sizeof(worker_arg_t));
         if (!arg) {
@@ -170,11 +229,19 @@ int main(int argc, char **argv) {
             goto join_and_exit;
         }
         arg->fd = cfd;
-        arg->msg_size = msg_size;
         arg->duration = duration;
         arg->start_ts = start_ts;
+        arg->io_flags = busy_poll_io_flags(&bp);
+        arg->dist = &dist;
+        arg->mem = &mem;
 
-        int rc = pthread_create(&tids[i], NULL, client_worker, arg);
+        // start the worker on the CPU that processes this connection's packets
+        pthread_attr_t attr;
+        int steered = cpu_steer_worker_attr(&cs, cfd, &attr);
+        int custom = mem_worker_attr(&mem, &attr, steered);
+        int rc = pthread_create(&tids[i], custom ? &attr : NULL, client_worker, arg);
+        if (custom)
+            pthread_attr_destroy(&attr);
         if (rc != 0) {
             fprintf(stderr, "pthread_create failed: %s\n", strerror(rc));
             close(cfd);
@@ -187,11 +254,18 @@ int main(int argc, char **argv) {
 join_and_exit:
     // no more accepts needed
     close(sfd);
+    mem_acct_sample(&mem, &start_ts, duration, tids, num_clients);
 
     for (int i = 0; i < num_clients; i++) {
         if (tids[i]) pthread_join(tids[i], NULL);
     }
 
     free(tids);
+    dist_free(&dist);
+    tcpinfo_stop(&ti);
+
+    mem_acct_report(&mem);
+    // CPU burned by the whole server (all workers), for the busy-poll tradeoff
+    printf("SERVER_SUMMARY cpu_s=%.6f busy_poll=%d\n", cpu_sec_self(), bp.enabled ? bp.usec : 0);
     return 0;
 }
@@ -1,7 +1,10 @@
 // MT25084_Part_A3_Client.c
 // A3 client: recv loop, prints SUMMARY
-// Usage: ./MT25084_Part_A3_Client <server_ip> <port> <msg_size> <duration_sec>
+// Usage: ./MT25084_Part_A3_Client <server_ip> <port> <msg_size> <duration_sec> [--busy-poll[=usec]]
+//        [--dist=<spec>] [--seed=<n>]   (must match the server; prints BUCKET lines)
+//        [--tcpinfo[=ms]] [--sndbuf=<bytes>] [--rcvbuf=<bytes>] [--steer-cpu]
 
+#define _GNU_SOURCE
 #include <arpa/inet.h>
 #include <errno.h>
 #include <netinet/in.h>
@@ -12,6 +15,12 @@
 #include <time.h>
 #include <unistd.h>
 
+#include "MT25084_Part_A_BusyPoll.h"
+#include "MT25084_Part_A_CpuSteer.h"
+#include "MT25084_Part_A_Dist.h"
+#include "MT25084_Part_A_SockBuf.h"
+#include "MT25084_Part_A_TcpInfo.h"
+
 static double now_sec(void) {
     struct timespec ts;
     clock_gettime(CLOCK_MONOTONIC, &ts);
@@ -20,7 +29,7 @@ static double now_sec(void) {
 
 int main(int argc, char **argv) {
     if (argc < 5) {
-        fprintf(stderr, "Usage: %s <server_ip> <port> <msg_size> <duration_sec>\n", argv[0]);
+        fprintf(stderr, "Usage: %s <server_ip> <port> <msg_size> <duration_sec> [--busy-poll[=usec]] [--dist=<spec>] [--seed=<n>] [--tcpinfo[=ms]] [--sndbuf=<bytes>] [--rcvbuf=<bytes>] [--steer-cpu]\n", argv[0]);
         return 1;
     }
 
@@ -34,8 +43,26 @@ int main(int argc, char **argv) {
         return 1;
     }
 
+    busy_poll_cfg_t bp = {0};
+    msg_dist_t dist = {0};
+    tcpinfo_sampler_t ti = {0};
+    sockbuf_cfg_t sb = {0};
+    cpu_steer_cfg_t cs = {0};
+    for (int i = 5; i < argc; i++) {
+        if (busy_poll_parse_opt(argv[i], &bp) == 1) continue;
+        if (dist_parse_opt(argv[i], &dist) == 1) continue;
+        if (tcpinfo_parse_opt(argv[i], &ti) == 1) continue;
+        if (sockbuf_parse_opt(argv[i], &sb) == 1) continue;
+        if (cpu_steer_parse_opt(argv[i], &cs) == 1) continue;
+        fprintf(stderr, "Unknown option: %s\n", argv[i]);
+        return 1;
+    }
+    int io_flags = busy_poll_io_flags(&bp);
+    if (dist_build(&dist, msg_size) < 0) return 1;
+
     int fd = socket(AF_INET, SOCK_STREAM, 0);
     if (fd < 0) { perror("socket"); return 1; }
+    sockbuf_apply(fd, &sb);
 
     struct sockaddr_in addr;
     memset(&addr, 0, sizeof(addr));
@@ -53,23 +80,31 @@ int main(int argc, char **argv) {
         close(fd);
         return 2;
     }
+    busy_poll_apply(fd, &bp);
+    tcpinfo_start(&ti, "cli");
+    tcpinfo_add(&ti, fd);
 
     char *buf = malloc((size_t)msg_size);
     if (!buf) { perror("malloc"); close(fd); return 1; }
 
     long long total_bytes = 0;
     long long total_msgs = 0;
+    dist_rx_t rx;
+    dist_rx_init(&rx, &dist);
 
     double t0 = now_sec();
     while (now_sec() - t0 < (double)duration) {
-        ssize_t n = recv(fd, buf, (size_t)msg_size, 0);
+        ssize_t n = recv(fd, buf, (size_t)msg_size, io_flags);
         if (n > 0) {
+            if (cs.pending) cpu_steer_pin_self(&cs, fd);
             total_bytes += (long long)n;
             total_msgs += 1;
+            if (dist.enabled) dist_rx_consume(&rx, &dist, n);
             continue;
         }
         if (n == 0) break;
         if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) continue; // busy-poll spin
         perror("recv");
         break;
     }
@@ -78,10 +113,14 @@ int main(int argc, char **argv) {
     double gbps = (elapsed > 0.0) ? ((double)total_bytes * 8.0) / (elapsed * 1e9) : 0.0;
     double avg_oneway_us = (total_msgs > 0) ? (elapsed / (double)total_msgs) * 1e6 : 0.0;
 
-    printf("SUMMARY bytes=%lld seconds=%.6f gbps=%.6f msgs=%lld avg_oneway_us=%.3f\n",
-           total_bytes, elapsed, gbps, total_msgs, avg_oneway_us);
+    printf("SUMMARY bytes=%lld seconds=%.6f gbps=%.6f msgs=%lld avg_oneway_us=%.3f cpu_s=%.6f\n",
+           total_bytes, elapsed, gbps, total_msgs, avg_oneway_us, cpu_sec_self());
+
+    if (dist.enabled) dist_rx_print(&rx, elapsed);
 
     free(buf);
+    dist_free(&dist);
+    tcpinfo_stop(&ti);
     shutdown(fd, SHUT_RDWR);
     close(fd);
     return 0;
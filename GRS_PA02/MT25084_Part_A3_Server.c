@@ -1,7 +1,10 @@
 // MT25084_Part_A3_Server.c
 // A3: Multi-client server (one thread per client)
 // Uses sendmsg() + MSG_ZEROCOPY if supported, otherwise falls back to send().
-// Usage: ./MT25084_Part_A3_Server <port> <msg_size> <duration_sec> <num_clients>
+// Usage: ./MT25084_Part_A3_Server <port> <msg_size> <duration_sec> <num_clients> [--busy-poll[=usec]]
+//        [--dist=<spec>] [--seed=<n>]   (see MT25084_Part_A_Dist.h; msg_size is then the max size)
+//        [--tcpinfo[=ms]] [--sndbuf=<bytes>] [--rcvbuf=<bytes>] [--steer-cpu]
+//        [--lowmem[=stack_kib]]   (small worker stacks + one shared payload, see MT25084_Part_A_MemAcct.h)
 
 #define _GNU_SOURCE
 #include <arpa/inet.h>
@@ -18,11 +21,20 @@
 #include <time.h>
 #include <unistd.h>
 
+#include "MT25084_Part_A_BusyPoll.h"
+#include "MT25084_Part_A_CpuSteer.h"
+#include "MT25084_Part_A_Dist.h"
+#include "MT25084_Part_A_MemAcct.h"
+#include "MT25084_Part_A_SockBuf.h"
+#include "MT25084_Part_A_TcpInfo.h"
+
 typedef struct {
     int fd;
-    int msg_size;
     int duration;
     struct timespec start_ts;
+    int io_flags; // MSG_DONTWAIT in busy-poll mode
+    const msg_dist_t *dist; // shared, read-only size table
+    mem_acct_t *mem;        // payload source (one shared buffer with --lowmem)
     int try_zerocopy;
 } worker_arg_t;
 
@@ -32,7 +44,7 @@ static double now_sec_monotonic(void) {
     return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
 }
 
-static int send_payload(int fd, const char *buf, int len, int *use_zc) {
+static int send_payload(int fd, const char *buf, int len, int *use_zc, int io_flags) {
     if (*use_zc) {
         struct iovec iov;
         iov.iov_base = (void *)buf;
@@ -43,8 +55,9 @@ static int send_payload(int fd, const char *buf, int len, int *use_zc) {
         msg.msg_iov = &iov;
         msg.msg_iovlen = 1;
 
-        ssize_t n = sendmsg(fd, &msg, MSG_ZEROCOPY);
+        ssize_t n = sendmsg(fd, &msg, MSG_ZEROCOPY | io_flags);
         if (n >= 0) return (int)n;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return -2; // busy-poll spin
 
         // If kernel doesn't support or disallows, fallback permanently
         if (errno == EINVAL || errno == EOPNOTSUPP || errno == ENOTSUP) {
@@ -60,41 +73,42 @@ static int send_payload(int fd, const char *buf, int len, int *use_zc) {
     }
 
     // fallback path
-    ssize_t n = send(fd, buf, (size_t)len, 0);
+    ssize_t n = send(fd, buf, (size_t)len, io_flags);
     if (n >= 0) return (int)n;
-    if (errno == EINTR) return -2;
+    if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) return -2;
     return -1;
 }
 
 static void *client_worker(void *vp) {
     worker_arg_t *arg = (worker_arg_t *)vp;
     int fd = arg->fd;
-    int msg_size = arg->msg_size;
     int duration = arg->duration;
     int use_zc = arg->try_zerocopy;
+    int io_flags = arg->io_flags;
+    const msg_dist_t *dist = arg->dist;
+    unsigned cursor = 0;
 
     double t0 = (double)arg->start_ts.tv_sec + (double)arg->start_ts.tv_nsec / 1e9;
 
-    char *buf = malloc((size_t)msg_size);
+    char *buf = mem_payload_get(arg->mem);
     if (!buf) {
-        perror("malloc");
         close(fd);
         free(arg);
         return NULL;
     }
-    memset(buf, 'Z', (size_t)msg_size);
 
     signal(SIGPIPE, SIG_IGN);
 
     while (now_sec_monotonic() - t0 < (double)duration) {
+        int len = dist_next(dist, &cursor);
         int sent = 0;
-        while (sent < msg_size) {
-            int rc = send_payload(fd, buf + sent, msg_size - sent, &use_zc);
+        while (sent < len) {
+            int rc = send_payload(fd, buf + sent, len - sent, &use_zc, io_flags);
             if (rc > 0) {
                 sent += rc;
                 continue;
             }
-            if (rc == -2) continue; // EINTR retry
+            if (rc == -2) continue; // EINTR / EAGAIN retry
             // other errors => stop
             goto done;
         }
@@ -103,14 +117,14 @@ static void *client_worker(void *vp) {
 done:
     shutdown(fd, SHUT_RDWR);
     close(fd);
-    free(buf);
+    mem_payload_put(arg->mem, buf);
     free(arg);
     return NULL;
 }
 
 int main(int argc, char **argv) {
     if (argc < 5) {
-        fprintf(stderr, "Usage: %s <port> <msg_size> <duration_sec> <num_clients>\n", argv[0]);
+        fprintf(stderr, "Usage: %s <port> <msg_size> <duration_sec> <num_clients> [--busy-poll[=usec]] [--dist=<spec>] [--seed=<n>] [--tcpinfo[=ms]] [--sndbuf=<bytes>] [--rcvbuf=<bytes>] [--steer-cpu] [--lowmem[=stack_kib]]\n", argv[0]);
         return 1;
     }
 
@@ -124,8 +138,28 @@ int main(int argc, char **argv) {
         return 1;
     }
 
+    busy_poll_cfg_t bp = {0};
+    msg_dist_t dist = {0};
+    tcpinfo_sampler_t ti = {0};
+    sockbuf_cfg_t sb = {0};
+    cpu_steer_cfg_t cs = {0};
+    mem_acct_t mem = {0};
+    for (int i = 5; i < argc; i++) {
+        if (busy_poll_parse_opt(argv[i], &bp) == 1) continue;
+        if (dist_parse_opt(argv[i], &dist) == 1) continue;
+        if (tcpinfo_parse_opt(argv[i], &ti) == 1) continue;
+        if (sockbuf_parse_opt(argv[i], &sb) == 1) continue;
+        if (cpu_steer_parse_opt(argv[i], &cs) == 1) continue;
+        if (mem_acct_parse_opt(argv[i], &mem) == 1) continue;
+        fprintf(stderr, "Unknown option: %s\n", argv[i]);
+        return 1;
+    }
+    if (dist_build(&dist, msg_size) < 0) return 1;
+    tcpinfo_start(&ti, "srv");
+
     int sfd = socket(AF_INET, SOCK_STREAM, 0);
     if (sfd < 0) { perror("socket"); return 1; }
+    sockbuf_apply(sfd, &sb);
 
     int opt = 1;
     setsockopt(sfd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
@@ -147,10 +181,15 @@ int main(int argc, char **argv) {
         return 1;
     }
 
-    printf("[A3 Server] listening on port %d | msg_size=%d | duration=%ds | clients=%d\n",
-           port, msg_size, duration, num_clients);
+    printf("[A3 Server] listening on port %d | msg_size=%d | duration=%ds | clients=%d | busy_poll=%d | dist=%s mean=%.1f\n",
+           port, msg_size, duration, num_clients, bp.enabled ? bp.usec : 0, dist.spec, dist.mean_size);
     fflush(stdout);
 
+    if (mem_acct_init(&mem, msg_size, 'Z', num_clients) < 0) {
+        close(sfd);
+        return 1;
+    }
+
     pthread_t *tids = calloc((size_t)num_clients, sizeof(pthread_t));
     if (!tids) { perror("calloc"); close(sfd); return 1; }
 
@@ -171,6 +210,10 @@ int main(int argc, char **argv) {
             goto join_and_exit;
         }
 
+        busy_poll_apply(cfd, &bp);
+        tcpinfo_add(&ti, cfd);
+        mem_acct_add(&mem, cfd);
+
         worker_arg_t *arg = malloc(sizeof(*arg));
         if (!arg) {
             perror("malloc");
@@ -180,12 +223,18 @@ int main(int argc, char **argv) {
         }
 
         arg->fd = cfd;
-        arg->msg_size = msg_size;
         arg->duration = duration;
         arg->start_ts = start_ts;
         arg->try_zerocopy = 1;
+        arg->io_flags = busy_poll_io_flags(&bp);
+        arg->dist = &dist;
+        arg->mem = &mem;
 
-        int rc = pthread_create(&tids[i], NULL, client_worker, arg);
+        pthread_attr_t attr;
+        int steered = cpu_steer_worker_attr(&cs, cfd, &attr);
+        int custom = mem_worker_attr(&mem, &attr, steered);
+        int rc = pthread_create(&tids[i], custom ? &attr : NULL, client_worker, arg);
+        if (custom) pthread_attr_destroy(&attr);
         if (rc != 0) {
             fprintf(stderr, "pthread_create: %s\n", strerror(rc));
             close(cfd);
@@ -197,9 +246,15 @@ int main(int argc, char **argv) {
 
 join_and_exit:
     close(sfd);
+    mem_acct_sample(&mem, &start_ts, duration, tids, num_clients);
     for (int i = 0; i < num_clients; i++) {
         if (tids[i]) pthread_join(tids[i], NULL);
     }
     free(tids);
+    dist_free(&dist);
+    tcpinfo_stop(&ti);
+
+    mem_acct_report(&mem);
+    printf("SERVER_SUMMARY cpu_s=%.6f busy_poll=%d\n", cpu_sec_self(), bp.enabled ? bp.usec : 0);
     return 0;
 }
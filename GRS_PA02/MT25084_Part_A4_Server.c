@@ -0,0 +1,609 @@
+// MT25084_Part_A4_Server.c
+// A4: Multi-client server (one thread per client), adaptive send engine.
+// Per connection and per message-size bucket, learns online which send path is
+// cheapest and routes every send accordingly:
+//   copy  - send()
+//   batch - one sendmsg() carrying up to --batch-depth queued messages
+//   zc    - sendmsg(MSG_ZEROCOPY), cost includes reaping completions (MSG_ERRQUEUE)
+// Cost = EWMA of CPU ns/byte of the sending thread (CLOCK_THREAD_CPUTIME_ID).
+// Time blocked on, or (busy-poll) spinning for, send buffer space is not the
+// path's cost and is left out, so a saturated stream does not flatten the
+// paths together; zero-copy completion reaping is charged to zc. A challenger
+// path only takes over when it is HYST_PCT cheaper than the current one; the
+// other paths are re-probed every PROBE_EVERY messages so the choice follows
+// changes in load.
+// Usage: ./MT25084_Part_A4_Server <port> <msg_size> <duration_sec> <num_clients> [--busy-poll[=usec]]
+//        [--dist=<spec>] [--seed=<n>]   (see MT25084_Part_A_Dist.h; msg_size is then the max size)
+//        [--tcpinfo[=ms]] [--sndbuf=<bytes>] [--rcvbuf=<bytes>] [--steer-cpu]
+//        [--lowmem[=stack_kib]]   (small worker stacks + one shared payload, see MT25084_Part_A_MemAcct.h)
+//        [--batch-depth=<n>]      (messages per batched sendmsg(), 1..BATCH_DEPTH_MAX, default BATCH_DEPTH)
+
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <errno.h>
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "MT25084_Part_A_BusyPoll.h"
+#include "MT25084_Part_A_CpuSteer.h"
+#include "MT25084_Part_A_Dist.h"
+#include "MT25084_Part_A_MemAcct.h"
+#include "MT25084_Part_A_SockBuf.h"
+#include "MT25084_Part_A_TcpInfo.h"
+
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+#ifndef SO_EE_CODE_ZEROCOPY_COPIED
+#define SO_EE_CODE_ZEROCOPY_COPIED 1
+#endif
+
+#define BATCH_DEPTH 8       // default --batch-depth
+#define BATCH_DEPTH_MAX 64
+#define EWMA_DIV 8.0        // alpha = 1/8
+#define MIN_SAMPLES 32      // timed sends per path before its cost is trusted
+#define HYST_PCT 10         // challenger must be this much cheaper to take over
+#define PROBE_EVERY 4096    // messages per bucket between re-probes
+#define PROBE_LEN 16        // timed sends per re-probe
+#define TIME_EVERY 16       // steady state: time 1 in N sends
+#define ZC_MAX_INFLIGHT 128 // unacknowledged MSG_ZEROCOPY calls before we wait
+
+enum { PATH_COPY = 0, PATH_BATCH, PATH_ZC, NPATHS };
+static const char *path_name[NPATHS] = {"copy", "batch", "zc"};
+
+typedef struct {
+    double cost[NPATHS]; // EWMA ns per byte
+    int samples[NPATHS];
+    int chosen;
+    int probe_path;
+    int probe_left;
+    unsigned probe_rot;
+    unsigned since_probe;
+} bucket_learner_t;
+
+typedef struct {
+    long long msgs[NPATHS];
+    long long bytes[NPATHS];
+    long long switches;
+    long long zc_completed;
+    long long zc_copied; // completions the kernel flagged as copied anyway
+    int zc_ok;
+} engine_stats_t;
+
+typedef struct {
+    int fd;
+    int io_flags;
+    int zc_ok;
+    unsigned zc_inflight; // MSG_ZEROCOPY calls not yet completed
+    unsigned timer_tick;
+    int timing;           // current send is measured
+    long long spin_from;  // CPU time of the first EAGAIN of the current spin, 0 = none
+    long long spin_ns;    // CPU spent spinning on EAGAIN during the current send
+    bucket_learner_t lb[DIST_MAX_BUCKETS];
+    engine_stats_t *st;
+} engine_t;
+
+typedef struct {
+    int fd;
+    int duration;
+    struct timespec start_ts;
+    int io_flags; // MSG_DONTWAIT in busy-poll mode
+    const msg_dist_t *dist; // shared, read-only size table
+    mem_acct_t *mem;        // payload source (one shared buffer with --lowmem)
+    int batch_depth;
+    int conn_port; // client port: the conn key of the TCPINFO/MEMCONN/STEER lines
+    engine_stats_t *stats; // slot owned by this worker, read by main after join
+} worker_arg_t;
+
+static double now_sec_monotonic(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static long long cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int path_usable(const engine_t *e, int p) {
+    return p != PATH_ZC || e->zc_ok;
+}
+
+static void engine_init(engine_t *e, int fd, int io_flags, engine_stats_t *st) {
+    memset(e, 0, sizeof(*e));
+    e->fd = fd;
+    e->io_flags = io_flags;
+    e->st = st;
+
+    // without SO_ZEROCOPY the kernel silently ignores MSG_ZEROCOPY
+    int one = 1;
+    e->zc_ok = setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0;
+    st->zc_ok = e->zc_ok;
+
+    for (int b = 0; b < DIST_MAX_BUCKETS; b++) {
+        e->lb[b].chosen = PATH_COPY;
+        e->lb[b].probe_path = PATH_COPY;
+    }
+}
+
+static void engine_disable_zc(engine_t *e) {
+    e->zc_ok = 0;
+    e->st->zc_ok = 0;
+    for (int b = 0; b < DIST_MAX_BUCKETS; b++) {
+        if (e->lb[b].chosen == PATH_ZC) e->lb[b].chosen = PATH_COPY;
+        if (e->lb[b].probe_path == PATH_ZC) e->lb[b].probe_left = 0;
+    }
+}
+
+// Which path carries the next message of bucket b; *timed says whether to measure it.
+static int engine_pick(engine_t *e, int b, int *timed) {
+    bucket_learner_t *l = &e->lb[b];
+
+    // explore: every usable path needs MIN_SAMPLES before the costs are compared
+    for (int p = 0; p < NPATHS; p++) {
+        if (path_usable(e, p) && l->samples[p] < MIN_SAMPLES) {
+            *timed = 1;
+            return p;
+        }
+    }
+
+    if (l->probe_left > 0) {
+        l->probe_left--;
+        *timed = 1;
+        return l->probe_path;
+    }
+
+    if (++l->since_probe >= PROBE_EVERY) {
+        l->since_probe = 0;
+        int p = (l->chosen + 1 + (int)(l->probe_rot++ % (NPATHS - 1))) % NPATHS;
+        if (!path_usable(e, p)) p = (p + 1) % NPATHS;
+        if (p != l->chosen && path_usable(e, p)) {
+            l->probe_path = p;
+            l->probe_left = PROBE_LEN - 1;
+            *timed = 1;
+            return p;
+        }
+    }
+
+    *timed = (++e->timer_tick % TIME_EVERY) == 0;
+    return l->chosen;
+}
+
+static void engine_learn(engine_t *e, int b, int p, long long ns, int bytes) {
+    bucket_learner_t *l = &e->lb[b];
+    double c = (double)ns / (double)bytes;
+
+    if (l->samples[p] == 0) l->cost[p] = c;
+    else l->cost[p] += (c - l->cost[p]) / EWMA_DIV;
+    l->samples[p]++;
+
+    int best = l->chosen;
+    for (int q = 0; q < NPATHS; q++) {
+        if (!path_usable(e, q) || l->samples[q] < MIN_SAMPLES) continue;
+        if (l->samples[best] < MIN_SAMPLES || l->cost[q] < l->cost[best]) best = q;
+    }
+    if (best == l->chosen || l->samples[best] < MIN_SAMPLES) return;
+
+    // hysteresis: keep the incumbent unless the challenger is clearly cheaper
+    if (l->samples[l->chosen] < MIN_SAMPLES ||
+        l->cost[best] < l->cost[l->chosen] * (100 - HYST_PCT) / 100.0) {
+        l->chosen = best;
+        e->st->switches++;
+    }
+}
+
+// Busy-poll spin accounting for timed sends: call spin_mark() right before a
+// send call and spin_note() with its outcome. The CPU from the first EAGAIN
+// up to the call that goes through is added to spin_ns.
+static long long spin_mark(const engine_t *e) {
+    return e->spin_from ? cpu_ns() : 0;
+}
+
+static void spin_note(engine_t *e, ssize_t n, long long t_call) {
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        if (e->timing && !e->spin_from) e->spin_from = cpu_ns();
+    } else if (e->spin_from) {
+        e->spin_ns += t_call - e->spin_from;
+        e->spin_from = 0;
+    }
+}
+
+static int send_all(engine_t *e, const char *buf, int len) {
+    int sent = 0;
+    while (sent < len) {
+        long long t_call = spin_mark(e);
+        ssize_t n = send(e->fd, buf + sent, (size_t)(len - sent), e->io_flags);
+        spin_note(e, n, t_call);
+        if (n > 0) { sent += (int)n; continue; }
+        if (n == 0) return -1;
+        if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) continue;
+        return -1;
+    }
+    return 0;
+}
+
+static int sendmsg_all(engine_t *e, struct iovec *iov, int cnt) {
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = (size_t)cnt;
+
+    while (msg.msg_iovlen > 0) {
+        long long t_call = spin_mark(e);
+        ssize_t n = sendmsg(e->fd, &msg, e->io_flags);
+        spin_note(e, n, t_call);
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) continue;
+            return -1;
+        }
+        // partial send: skip what went out and resend the rest
+        while (n > 0 && msg.msg_iovlen > 0) {
+            if ((size_t)n >= msg.msg_iov->iov_len) {
+                n -= (ssize_t)msg.msg_iov->iov_len;
+                msg.msg_iov++;
+                msg.msg_iovlen--;
+            } else {
+                msg.msg_iov->iov_base = (char *)msg.msg_iov->iov_base + n;
+                msg.msg_iov->iov_len -= (size_t)n;
+                n = 0;
+            }
+        }
+    }
+    return 0;
+}
+
+// Drain MSG_ZEROCOPY completion notifications. wait_ms > 0 first waits for one.
+static int zc_reap(engine_t *e, int wait_ms) {
+    if (wait_ms > 0) {
+        struct pollfd pfd = { .fd = e->fd, .events = 0 }; // POLLERR is always reported
+        poll(&pfd, 1, wait_ms);
+    }
+    for (;;) {
+        char control[128];
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (recvmsg(e->fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return 0;
+            return -1;
+        }
+        for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+            if (!(cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR)) continue;
+            struct sock_extended_err serr;
+            memcpy(&serr, CMSG_DATA(cm), sizeof(serr));
+            if (serr.ee_errno != 0 || serr.ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+
+            // one notification covers the range of send calls [ee_info, ee_data]
+            unsigned n = serr.ee_data - serr.ee_info + 1;
+            e->zc_inflight = n > e->zc_inflight ? 0 : e->zc_inflight - n;
+            e->st->zc_completed += n;
+            if (serr.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) e->st->zc_copied += n;
+        }
+    }
+}
+
+static int send_zc(engine_t *e, const char *buf, int len) {
+    int sent = 0;
+    while (sent < len) {
+        if (e->zc_inflight >= ZC_MAX_INFLIGHT && zc_reap(e, 1) < 0) return -1;
+
+        struct iovec iov;
+        iov.iov_base = (void *)(buf + sent);
+        iov.iov_len = (size_t)(len - sent);
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+
+        long long t_call = spin_mark(e);
+        ssize_t n = sendmsg(e->fd, &msg, MSG_ZEROCOPY | e->io_flags);
+        spin_note(e, n, t_call);
+        if (n > 0) {
+            sent += (int)n;
+            e->zc_inflight++;
+            continue;
+        }
+        if (n == 0) return -1;
+        if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) continue;
+        if (errno == ENOBUFS && e->zc_inflight > 0) {
+            // optmem full of notifications: reap and retry
+            if (zc_reap(e, 1) < 0) return -1;
+            continue;
+        }
+        if (errno == ENOBUFS || errno == EINVAL || errno == EOPNOTSUPP ||
+            errno == ENOTSUP || errno == EPERM) {
+            // not usable on this socket: drop the path for good
+            engine_disable_zc(e);
+            return send_all(e, buf + sent, len - sent);
+        }
+        return -1;
+    }
+    // reaping is part of the zero-copy cost, so it is done (and timed) here
+    return zc_reap(e, 0);
+}
+
+static void *client_worker(void *vp) {
+    worker_arg_t *arg = (worker_arg_t *)vp;
+    int fd = arg->fd;
+    int duration = arg->duration;
+    int io_flags = arg->io_flags;
+    const msg_dist_t *dist = arg->dist;
+    unsigned cursor = 0;
+    engine_stats_t *st = arg->stats;
+
+    double t0 = (double)arg->start_ts.tv_sec + (double)arg->start_ts.tv_nsec / 1e9;
+
+    char *buf = mem_payload_get(arg->mem);
+    if (!buf) {
+        close(fd);
+        free(arg);
+        return NULL;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    engine_t *e = malloc(sizeof(*e));
+    if (!e) {
+        perror("malloc");
+        close(fd);
+        mem_payload_put(arg->mem, buf);
+        free(arg);
+        return NULL;
+    }
+    engine_init(e, fd, io_flags, st);
+
+    while (now_sec_monotonic() - t0 < (double)duration) {
+        int len = dist_next(dist, &cursor);
+        int b = dist_bucket(len);
+        int timed;
+        int path = engine_pick(e, b, &timed);
+        e->timing = timed;
+        e->spin_ns = 0;
+        e->spin_from = 0;
+        long long t_start = timed ? cpu_ns() : 0;
+        int nmsgs = 1;
+        int nbytes = len;
+        int rc;
+
+        if (path == PATH_BATCH) {
+            // coalesce following messages of this bucket, or of buckets that batch too
+            struct iovec iov[BATCH_DEPTH_MAX];
+            iov[0].iov_base = buf;
+            iov[0].iov_len = (size_t)len;
+            while (nmsgs < arg->batch_depth) {
+                int nl = dist->table[cursor & DIST_TABLE_MASK];
+                int nb = dist_bucket(nl);
+                if (nb != b && e->lb[nb].chosen != PATH_BATCH) break;
+                cursor++;
+                iov[nmsgs].iov_base = buf;
+                iov[nmsgs].iov_len = (size_t)nl;
+                nmsgs++;
+                nbytes += nl;
+            }
+            rc = sendmsg_all(e, iov, nmsgs);
+        } else if (path == PATH_ZC) {
+            rc = send_zc(e, buf, len);
+        } else {
+            rc = send_all(e, buf, len);
+        }
+        if (rc < 0) break;
+
+        if (timed) {
+            long long ns = cpu_ns() - t_start - e->spin_ns;
+            engine_learn(e, b, path, ns > 0 ? ns : 0, nbytes);
+            e->timing = 0;
+        }
+        st->msgs[path] += nmsgs;
+        st->bytes[path] += nbytes;
+    }
+
+    // let outstanding zero-copy sends complete before the buffer goes away
+    for (int i = 0; i < 50 && e->zc_inflight > 0; i++) {
+        if (zc_reap(e, 1) < 0) break;
+    }
+
+    // per-connection routing table: bucket upper bound -> chosen path
+    char routes[512];
+    int off = 0;
+    long long zc_crossover = 0; // 64-bit: bucket 31 bound does not fit in an int
+    routes[0] = '\0';
+    for (int b = 0; b < DIST_MAX_BUCKETS; b++) {
+        const bucket_learner_t *l = &e->lb[b];
+        int seen = 0;
+        for (int p = 0; p < NPATHS; p++) seen |= l->samples[p] > 0;
+        if (!seen) continue;
+        if (l->chosen == PATH_ZC && zc_crossover == 0) zc_crossover = 1LL << b;
+        if (off < (int)sizeof(routes))
+            off += snprintf(routes + off, sizeof(routes) - (size_t)off, "%s%lld:%s",
+                            off ? "," : "", 1LL << b, path_name[l->chosen]);
+    }
+    printf("ENGINE conn=%d zc_ok=%d copy_msgs=%lld batch_msgs=%lld zc_msgs=%lld switches=%lld "
+           "zc_completed=%lld zc_copied=%lld zc_crossover=%lld routes=%s\n",
+           arg->conn_port, st->zc_ok, st->msgs[PATH_COPY], st->msgs[PATH_BATCH], st->msgs[PATH_ZC],
+           st->switches, st->zc_completed, st->zc_copied, zc_crossover, routes);
+    fflush(stdout);
+
+    shutdown(fd, SHUT_RDWR);
+    close(fd);
+    free(e);
+    mem_payload_put(arg->mem, buf);
+    free(arg);
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 5) {
+        fprintf(stderr, "Usage: %s <port> <msg_size> <duration_sec> <num_clients> [--busy-poll[=usec]] [--dist=<spec>] [--seed=<n>] [--tcpinfo[=ms]] [--sndbuf=<bytes>] [--rcvbuf=<bytes>] [--steer-cpu] [--lowmem[=stack_kib]] [--batch-depth=<n>]\n", argv[0]);
+        return 1;
+    }
+
+    int port = atoi(argv[1]);
+    int msg_size = atoi(argv[2]);
+    int duration = atoi(argv[3]);
+    int num_clients = atoi(argv[4]);
+
+    if (port <= 0 || msg_size <= 0 || duration <= 0 || num_clients <= 0) {
+        fprintf(stderr, "Invalid args.\n");
+        return 1;
+    }
+
+    busy_poll_cfg_t bp = {0};
+    msg_dist_t dist = {0};
+    tcpinfo_sampler_t ti = {0};
+    sockbuf_cfg_t sb = {0};
+    cpu_steer_cfg_t cs = {0};
+    mem_acct_t mem = {0};
+    int batch_depth = BATCH_DEPTH;
+    for (int i = 5; i < argc; i++) {
+        if (busy_poll_parse_opt(argv[i], &bp) == 1) continue;
+        if (dist_parse_opt(argv[i], &dist) == 1) continue;
+        if (tcpinfo_parse_opt(argv[i], &ti) == 1) continue;
+        if (sockbuf_parse_opt(argv[i], &sb) == 1) continue;
+        if (cpu_steer_parse_opt(argv[i], &cs) == 1) continue;
+        if (mem_acct_parse_opt(argv[i], &mem) == 1) continue;
+        if (strncmp(argv[i], "--batch-depth=", 14) == 0 &&
+            (batch_depth = atoi(argv[i] + 14)) > 0 && batch_depth <= BATCH_DEPTH_MAX) continue;
+        fprintf(stderr, "Unknown option: %s\n", argv[i]);
+        return 1;
+    }
+    if (dist_build(&dist, msg_size) < 0) return 1;
+    tcpinfo_start(&ti, "srv");
+
+    int sfd = socket(AF_INET, SOCK_STREAM, 0);
+    if (sfd < 0) { perror("socket"); return 1; }
+    sockbuf_apply(sfd, &sb);
+
+    int opt = 1;
+    setsockopt(sfd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    if (bind(sfd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        close(sfd);
+        return 1;
+    }
+    if (listen(sfd, 128) < 0) {
+        perror("listen");
+        close(sfd);
+        return 1;
+    }
+
+    printf("[A4 Server] listening on port %d | msg_size=%d | duration=%ds | clients=%d | busy_poll=%d | dist=%s mean=%.1f | batch_depth=%d\n",
+           port, msg_size, duration, num_clients, bp.enabled ? bp.usec : 0, dist.spec, dist.mean_size, batch_depth);
+    fflush(stdout);
+
+    if (mem_acct_init(&mem, msg_size, 'Z', num_clients) < 0) {
+        close(sfd);
+        return 1;
+    }
+
+    pthread_t *tids = calloc((size_t)num_clients, sizeof(pthread_t));
+    engine_stats_t *stats = calloc((size_t)num_clients, sizeof(engine_stats_t));
+    if (!tids || !stats) { perror("calloc"); close(sfd); return 1; }
+
+    struct timespec start_ts;
+    clock_gettime(CLOCK_MONOTONIC, &start_ts);
+
+    for (int i = 0; i < num_clients; i++) {
+        struct sockaddr_in caddr;
+        socklen_t clen = sizeof(caddr);
+
+        int cfd;
+        while (1) {
+            cfd = accept(sfd, (struct sockaddr *)&caddr, &clen);
+            if (cfd >= 0) break;
+            if (errno == EINTR) continue;
+            perror("accept");
+            num_clients = i;
+            goto join_and_exit;
+        }
+
+        busy_poll_apply(cfd, &bp);
+        tcpinfo_add(&ti, cfd);
+        mem_acct_add(&mem, cfd);
+
+        worker_arg_t *arg = malloc(sizeof(*arg));
+        if (!arg) {
+            perror("malloc");
+            close(cfd);
+            num_clients = i;
+            goto join_and_exit;
+        }
+
+        arg->fd = cfd;
+        arg->duration = duration;
+        arg->start_ts = start_ts;
+        arg->io_flags = busy_poll_io_flags(&bp);
+        arg->dist = &dist;
+        arg->mem = &mem;
+        arg->batch_depth = batch_depth;
+        arg->conn_port = ntohs(caddr.sin_port);  // accept() filled in the peer address
+        arg->stats = &stats[i];
+
+        pthread_attr_t attr;
+        int steered = cpu_steer_worker_attr(&cs, cfd, &attr);
+        int custom = mem_worker_attr(&mem, &attr, steered);
+        int rc = pthread_create(&tids[i], custom ? &attr : NULL, client_worker, arg);
+        if (custom) pthread_attr_destroy(&attr);
+        if (rc != 0) {
+            fprintf(stderr, "pthread_create: %s\n", strerror(rc));
+            close(cfd);
+            free(arg);
+            num_clients = i;
+            goto join_and_exit;
+        }
+    }
+
+join_and_exit:
+    close(sfd);
+    mem_acct_sample(&mem, &start_ts, duration, tids, num_clients);
+    for (int i = 0; i < num_clients; i++) {
+        if (tids[i]) pthread_join(tids[i], NULL);
+    }
+
+    // chosen-path totals over all connections
+    long long msgs[NPATHS] = {0};
+    long long bytes[NPATHS] = {0};
+    long long switches = 0;
+    for (int i = 0; i < num_clients; i++) {
+        for (int p = 0; p < NPATHS; p++) {
+            msgs[p] += stats[i].msgs[p];
+            bytes[p] += stats[i].bytes[p];
+        }
+        switches += stats[i].switches;
+    }
+
+    free(tids);
+    free(stats);
+    dist_free(&dist);
+    tcpinfo_stop(&ti);
+
+    mem_acct_report(&mem);
+    printf("SERVER_SUMMARY cpu_s=%.6f busy_poll=%d copy_msgs=%lld batch_msgs=%lld zc_msgs=%lld "
+           "copy_bytes=%lld batch_bytes=%lld zc_bytes=%lld switches=%lld\n",
+           cpu_sec_self(), bp.enabled ? bp.usec : 0, msgs[PATH_COPY], msgs[PATH_BATCH], msgs[PATH_ZC],
+           bytes[PATH_COPY], bytes[PATH_BATCH], bytes[PATH_ZC], switches);
+    return 0;
+}
@@ -0,0 +1,286 @@
+// MT25084_Part_A5_Client.c
+// A5 client: AF_XDP raw-frame receiver, prints one SUMMARY per flow.
+// All flows of a run live in this one process (--flows=<n>, one thread and one
+// AF_XDP socket per flow): an interface takes a single XDP program, so the
+// program and its XSKMAP are shared instead of being attached per process.
+// Each flow opens a TCP control connection to the server, gets its veth queue
+// and the server MAC, binds its socket to that queue and then receives DATA
+// frames, returning a cumulative ACK every XSK_ACK_EVERY frames.
+// SUMMARY adds frames= and lost= (sequence gaps); msgs counts complete messages.
+// Flows share the process, so a flow's SUMMARY carries its thread CPU as
+// flow_cpu_s=; the process CPU (cpu_s=, as every other client reports it) is
+// printed once at exit: CLIENT_SUMMARY cpu_s=.. flows=..
+// After a gap, reassembly resyncs at the next frame flagged XSK_F_FIRST, so
+// only the messages that actually lost frames are dropped.
+// Usage: ./MT25084_Part_A5_Client <server_ip> <port> <msg_size> <duration_sec> [--busy-poll[=usec]]
+//        [--dist=<spec>] [--seed=<n>]   (must match the server; prints BUCKET lines)
+//        [--flows=<n>] [--xdp-mode=drv|skb] [--steer-cpu]
+// The TCP-only options (--tcpinfo, --sndbuf, --rcvbuf) are rejected: no TCP data path.
+
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "MT25084_Part_A_BusyPoll.h"
+#include "MT25084_Part_A_CpuSteer.h"
+#include "MT25084_Part_A_Dist.h"
+#include "MT25084_Part_A_Xsk.h"
+
+typedef struct {
+    int fd;   // TCP control connection
+    int flow; // = queue id, assigned by the server
+    int duration;
+    int steer;
+    const busy_poll_cfg_t *bp;
+    const msg_dist_t *dist;
+    const xsk_iface_t *ifc;
+    uint8_t server_mac[ETH_ALEN];
+} flow_arg_t;
+
+static pthread_mutex_t print_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static double cpu_sec_thread(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void *flow_worker(void *vp) {
+    flow_arg_t *arg = (flow_arg_t *)vp;
+    const msg_dist_t *dist = arg->dist;
+    int busy = arg->bp->enabled;
+
+    long long total_bytes = 0;
+    long long total_msgs = 0;
+    unsigned long long frames = 0, lost = 0;
+    dist_rx_t rx;
+    memset(&rx, 0, sizeof(rx));
+    double t0 = now_sec();
+
+    xsk_sock_t *xs = calloc(1, sizeof(*xs));
+    if (!xs) {
+        perror("calloc");
+        goto out;
+    }
+    xs->fd = -1;
+
+    if (arg->steer) {
+        int cpu = arg->flow % (int)sysconf(_SC_NPROCESSORS_ONLN);
+        if (cpu_steer_pin_to(cpu) == 0) cpu_steer_log("cli", arg->fd, cpu);
+    }
+
+    if (xsk_open(xs, arg->ifc, arg->flow, arg->server_mac) < 0) goto out;
+    busy_poll_apply(xs->fd, arg->bp);
+
+    // socket is in the XSKMAP: let the server start
+    if (send(arg->fd, "R", 1, 0) != 1) {
+        perror("send(ready)");
+        goto out;
+    }
+
+    uint64_t expected = 0;
+    uint32_t since_ack = 0;
+    uint32_t msg_have = 0;
+    int msg_ok = 1; // no frame of the current message was lost
+    struct pollfd pfd = { xs->fd, POLLIN, 0 };
+
+    t0 = now_sec();
+    while (now_sec() - t0 < (double)arg->duration) {
+        uint32_t idx, n = xsk_cons_peek(&xs->rx, XSK_BATCH, &idx);
+        if (n == 0) {
+            // stream paused: do not leave the server waiting for a full ACK batch
+            if (since_ack && xsk_send_ack(xs, (uint32_t)arg->flow, expected)) since_ack = 0;
+            if (!busy) poll(&pfd, 1, 10);
+            else if (*xs->fill.flags & XDP_RING_NEED_WAKEUP) recvfrom(xs->fd, NULL, 0, MSG_DONTWAIT, NULL, NULL);
+            continue;
+        }
+
+        for (uint32_t i = 0; i < n; i++) {
+            const struct xdp_desc *d = xsk_ring_desc(&xs->rx, idx + i);
+            const xsk_hdr_t *h = (const xsk_hdr_t *)(xs->umem + d->addr + ETH_HLEN);
+            if (h->type != XSK_T_DATA || h->flow != (uint32_t)arg->flow) continue;
+            if (h->seq != expected) {
+                if (h->seq < expected) continue; // stale
+                lost += h->seq - expected;
+                msg_ok = 0;
+            }
+            if (h->flags & XSK_F_FIRST) {
+                // a message starts here, whatever was lost before it
+                msg_have = 0;
+                msg_ok = 1;
+            }
+            expected = h->seq + 1;
+            frames++;
+            total_bytes += h->len;
+            msg_have += h->len;
+            if (h->flags & XSK_F_LAST) {
+                if (msg_ok && msg_have == h->msg_len) {
+                    total_msgs++;
+                    if (dist->enabled) {
+                        dist_bucket_t *b = &rx.buckets[dist_bucket((int)h->msg_len)];
+                        b->msgs += 1;
+                        b->bytes += h->msg_len;
+                    }
+                }
+                msg_have = 0;
+                msg_ok = 1;
+            }
+        }
+        xsk_recycle_rx(xs, idx, n);
+
+        since_ack += n;
+        if (since_ack >= XSK_ACK_EVERY && xsk_send_ack(xs, (uint32_t)arg->flow, expected)) since_ack = 0;
+    }
+
+out:;
+    double elapsed = now_sec() - t0;
+    double gbps = (elapsed > 0.0) ? ((double)total_bytes * 8.0) / (elapsed * 1e9) : 0.0;
+    double avg_oneway_us = (total_msgs > 0) ? (elapsed / (double)total_msgs) * 1e6 : 0.0;
+
+    pthread_mutex_lock(&print_lock);
+    printf("SUMMARY bytes=%lld seconds=%.6f gbps=%.6f msgs=%lld avg_oneway_us=%.3f flow_cpu_s=%.6f frames=%llu lost=%llu\n",
+           total_bytes, elapsed, gbps, total_msgs, avg_oneway_us, cpu_sec_thread(), frames, lost);
+    if (dist->enabled) dist_rx_print(&rx, elapsed);
+    fflush(stdout);
+    pthread_mutex_unlock(&print_lock);
+
+    if (xs) {
+        xsk_close(xs);
+        free(xs);
+    }
+    shutdown(arg->fd, SHUT_RDWR);
+    close(arg->fd);
+    free(arg);
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 5) {
+        fprintf(stderr, "Usage: %s <server_ip> <port> <msg_size> <duration_sec> [--busy-poll[=usec]] [--dist=<spec>] [--seed=<n>] [--flows=<n>] [--xdp-mode=drv|skb] [--steer-cpu]\n", argv[0]);
+        return 1;
+    }
+
+    const char *ip = argv[1];
+    int port = atoi(argv[2]);
+    int msg_size = atoi(argv[3]);
+    int duration = atoi(argv[4]);
+
+    if (port <= 0 || msg_size <= 0 || duration <= 0) {
+        fprintf(stderr, "Invalid args.\n");
+        return 1;
+    }
+
+    busy_poll_cfg_t bp = {0};
+    msg_dist_t dist = {0};
+    cpu_steer_cfg_t cs = {0};
+    xsk_cfg_t xc = {0};
+    int flows = 1;
+    for (int i = 5; i < argc; i++) {
+        if (busy_poll_parse_opt(argv[i], &bp) == 1) continue;
+        if (dist_parse_opt(argv[i], &dist) == 1) continue;
+        if (cpu_steer_parse_opt(argv[i], &cs) == 1) continue;
+        if (xsk_parse_opt(argv[i], &xc) == 1) continue;
+        if (strncmp(argv[i], "--flows=", 8) == 0 && (flows = atoi(argv[i] + 8)) > 0) continue;
+        fprintf(stderr, "Unknown option: %s\n", argv[i]);
+        return 1;
+    }
+    if (dist_build(&dist, msg_size) < 0) return 1;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+
+    if (inet_pton(AF_INET, ip, &addr.sin_addr) != 1) {
+        fprintf(stderr, "inet_pton failed for %s\n", ip);
+        return 1;
+    }
+
+    pthread_t *tids = calloc((size_t)flows, sizeof(pthread_t));
+    if (!tids) { perror("calloc"); return 1; }
+
+    xsk_iface_t ifc;
+    memset(&ifc, 0, sizeof(ifc));
+    ifc.map_fd = ifc.prog_fd = ifc.link_fd = -1;
+
+    int rcode = 0;
+    for (int i = 0; i < flows; i++) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) { perror("socket"); rcode = 1; break; }
+
+        if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+            perror("connect");
+            close(fd);
+            rcode = 2;
+            break;
+        }
+
+        if (ifc.link_fd < 0 && (xsk_iface_from_fd(fd, &ifc) < 0 || xsk_iface_attach(&ifc, &xc) < 0)) {
+            close(fd);
+            rcode = 1;
+            break;
+        }
+
+        xsk_hello_t hello;
+        memset(&hello, 0, sizeof(hello));
+        memcpy(hello.mac, ifc.mac, ETH_ALEN);
+        if (send(fd, &hello, sizeof(hello), 0) != (ssize_t)sizeof(hello) ||
+            recv(fd, &hello, sizeof(hello), MSG_WAITALL) != (ssize_t)sizeof(hello)) {
+            perror("hello");
+            close(fd);
+            rcode = 1;
+            break;
+        }
+        if (hello.status != 0 || (int)hello.queue >= ifc.nqueues) {
+            fprintf(stderr, "flow %d: no free queue (needs %d queues on both ends, drv mode for more than 1)\n", i, flows);
+            close(fd);
+            rcode = 1;
+            break;
+        }
+
+        flow_arg_t *arg = malloc(sizeof(*arg));
+        if (!arg) { perror("malloc"); close(fd); rcode = 1; break; }
+        arg->fd = fd;
+        arg->flow = (int)hello.queue;
+        arg->duration = duration;
+        arg->steer = cs.enabled;
+        arg->bp = &bp;
+        arg->dist = &dist;
+        arg->ifc = &ifc;
+        memcpy(arg->server_mac, hello.mac, ETH_ALEN);
+
+        int rc = pthread_create(&tids[i], NULL, flow_worker, arg);
+        if (rc != 0) {
+            fprintf(stderr, "pthread_create: %s\n", strerror(rc));
+            close(fd);
+            free(arg);
+            rcode = 1;
+            break;
+        }
+    }
+
+    for (int i = 0; i < flows; i++) {
+        if (tids[i]) pthread_join(tids[i], NULL);
+    }
+    printf("CLIENT_SUMMARY cpu_s=%.6f flows=%d\n", cpu_sec_self(), flows);
+    fflush(stdout);
+    free(tids);
+    dist_free(&dist);
+    xsk_iface_detach(&ifc);
+    return rcode;
+}
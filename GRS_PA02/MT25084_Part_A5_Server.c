@@ -0,0 +1,334 @@
+// MT25084_Part_A5_Server.c
+// A5: AF_XDP raw-frame sender (one thread + one AF_XDP socket per client).
+// No TCP on the data path: messages go out as raw Ethernet frames from a UMEM
+// (see MT25084_Part_A_Xsk.h for the rings, the XDP program and the framing).
+// Each frame's payload is copied into the UMEM from a user-space message
+// buffer, as A1-A3 copy theirs into the socket, so the floor keeps that cost.
+// A TCP connection per client is kept only as control channel: it hands out
+// the veth queue (= flow id) and MAC addresses, and tells the server when the
+// client's socket is ready. Needs root and a veth with >= num_clients queues.
+// Usage: ./MT25084_Part_A5_Server <port> <msg_size> <duration_sec> <num_clients> [--busy-poll[=usec]]
+//        [--dist=<spec>] [--seed=<n>]   (see MT25084_Part_A_Dist.h; msg_size is then the max size)
+//        [--xdp-mode=drv|skb] [--steer-cpu]   (steer: flow q runs on CPU q, matching the harness XPS map)
+// The TCP-only options (--tcpinfo, --sndbuf, --rcvbuf) are rejected: no TCP data path.
+
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "MT25084_Part_A_BusyPoll.h"
+#include "MT25084_Part_A_CpuSteer.h"
+#include "MT25084_Part_A_Dist.h"
+#include "MT25084_Part_A_Xsk.h"
+
+typedef struct {
+    int fd;   // TCP control connection
+    int flow; // = queue id
+    int duration;
+    int steer;
+    int msg_size; // largest message: size of the payload buffer
+    const busy_poll_cfg_t *bp;
+    const msg_dist_t *dist; // shared, read-only size table
+    const xsk_iface_t *ifc;
+    uint8_t peer_mac[ETH_ALEN];
+} flow_arg_t;
+
+static double now_sec_monotonic(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void *flow_worker(void *vp) {
+    flow_arg_t *arg = (flow_arg_t *)vp;
+    const msg_dist_t *dist = arg->dist;
+    int busy = arg->bp->enabled;
+    unsigned cursor = 0;
+
+    xsk_sock_t *xs = calloc(1, sizeof(*xs));
+    if (!xs) {
+        perror("calloc");
+        close(arg->fd);
+        free(arg);
+        return NULL;
+    }
+    xs->fd = -1;
+
+    char *payload = malloc((size_t)arg->msg_size);
+    if (!payload) {
+        perror("malloc");
+        free(xs);
+        close(arg->fd);
+        free(arg);
+        return NULL;
+    }
+    memset(payload, 'A', (size_t)arg->msg_size);
+
+    if (arg->steer) {
+        int cpu = arg->flow % (int)sysconf(_SC_NPROCESSORS_ONLN);
+        if (cpu_steer_pin_to(cpu) == 0) cpu_steer_log("srv", arg->fd, cpu);
+    }
+
+    unsigned long long frames = 0, msgs = 0, bytes = 0, stalls = 0;
+    uint64_t seq = 0, acked = 0;
+
+    if (xsk_open(xs, arg->ifc, arg->flow, arg->peer_mac) < 0) goto done;
+    busy_poll_apply(xs->fd, arg->bp);
+
+    // the client sends one byte once its own socket is in its XSKMAP
+    char go;
+    if (recv(arg->fd, &go, 1, MSG_WAITALL) != 1) {
+        fprintf(stderr, "flow %d: client never became ready\n", arg->flow);
+        goto done;
+    }
+
+    int max_pay = xsk_max_payload(arg->ifc);
+    uint32_t cur_len = (uint32_t)dist_next(dist, &cursor);
+    uint32_t cur_left = cur_len;
+    struct pollfd pfd = { xs->fd, POLLIN, 0 };
+
+    double t0 = now_sec_monotonic();
+    double now = t0, last_ack = t0;
+    while ((now = now_sec_monotonic()) - t0 < (double)arg->duration) {
+        xsk_reap_tx(xs);
+
+        // cumulative ACKs from the client
+        uint32_t idx, n = xsk_cons_peek(&xs->rx, XSK_BATCH, &idx);
+        if (n) {
+            for (uint32_t i = 0; i < n; i++) {
+                const struct xdp_desc *d = xsk_ring_desc(&xs->rx, idx + i);
+                const xsk_hdr_t *h = (const xsk_hdr_t *)(xs->umem + d->addr + ETH_HLEN);
+                if (h->type == XSK_T_ACK && h->flow == (uint32_t)arg->flow && h->seq > acked && h->seq <= seq) {
+                    acked = h->seq;
+                    last_ack = now;
+                }
+            }
+            xsk_recycle_rx(xs, idx, n);
+        }
+
+        uint32_t room = XSK_WINDOW - (uint32_t)(seq - acked);
+        if (room > xs->nfree_tx) room = xs->nfree_tx;
+        if (room > XSK_BATCH) room = XSK_BATCH;
+        if (room == 0) {
+            if (seq - acked >= XSK_WINDOW && now - last_ack > XSK_STALL_MS / 1e3) {
+                // the ACK (or the frames it covers) was lost: reopen the window
+                acked = seq;
+                last_ack = now;
+                stalls++;
+            } else if (!busy) {
+                poll(&pfd, 1, 1);
+            }
+            xsk_kick_tx(xs);
+            continue;
+        }
+
+        n = xsk_prod_reserve(&xs->tx, room, &idx);
+        for (uint32_t i = 0; i < n; i++) {
+            uint64_t addr = xs->free_tx[--xs->nfree_tx];
+            uint32_t len = cur_left < (uint32_t)max_pay ? cur_left : (uint32_t)max_pay;
+            memcpy(xs->umem + addr + XSK_HDR_LEN, payload + (cur_len - cur_left), len);
+            uint16_t flags = cur_left == cur_len ? XSK_F_FIRST : 0;
+            cur_left -= len;
+            if (cur_left == 0) flags |= XSK_F_LAST;
+
+            xsk_hdr_t *h = xsk_frame_hdr(xs, addr);
+            h->flow = (uint32_t)arg->flow;
+            h->type = XSK_T_DATA;
+            h->flags = flags;
+            h->seq = seq++;
+            h->msg_len = cur_len;
+            h->len = len;
+
+            struct xdp_desc *d = xsk_ring_desc(&xs->tx, idx + i);
+            d->addr = addr;
+            d->len = (uint32_t)XSK_HDR_LEN + len;
+            d->options = 0;
+
+            if (cur_left == 0) {
+                msgs++;
+                bytes += cur_len;
+                cur_len = (uint32_t)dist_next(dist, &cursor);
+                cur_left = cur_len;
+            }
+        }
+        frames += n;
+        xsk_prod_submit(&xs->tx);
+        xsk_kick_tx(xs);
+    }
+
+done:
+    printf("XSK side=srv flow=%d queue=%d mode=%s frames=%llu msgs=%llu bytes=%llu acked=%llu stalls=%llu\n",
+           arg->flow, arg->flow, arg->ifc->mode, frames, msgs, bytes, (unsigned long long)acked, stalls);
+    fflush(stdout);
+
+    xsk_close(xs);
+    free(xs);
+    free(payload);
+    shutdown(arg->fd, SHUT_RDWR);
+    close(arg->fd);
+    free(arg);
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 5) {
+        fprintf(stderr, "Usage: %s <port> <msg_size> <duration_sec> <num_clients> [--busy-poll[=usec]] [--dist=<spec>] [--seed=<n>] [--xdp-mode=drv|skb] [--steer-cpu]\n", argv[0]);
+        return 1;
+    }
+
+    int port = atoi(argv[1]);
+    int msg_size = atoi(argv[2]);
+    int duration = atoi(argv[3]);
+    int num_clients = atoi(argv[4]);
+
+    if (port <= 0 || msg_size <= 0 || duration <= 0 || num_clients <= 0) {
+        fprintf(stderr, "Invalid args.\n");
+        return 1;
+    }
+
+    busy_poll_cfg_t bp = {0};
+    msg_dist_t dist = {0};
+    cpu_steer_cfg_t cs = {0};
+    xsk_cfg_t xc = {0};
+    for (int i = 5; i < argc; i++) {
+        if (busy_poll_parse_opt(argv[i], &bp) == 1) continue;
+        if (dist_parse_opt(argv[i], &dist) == 1) continue;
+        if (cpu_steer_parse_opt(argv[i], &cs) == 1) continue;
+        if (xsk_parse_opt(argv[i], &xc) == 1) continue;
+        fprintf(stderr, "Unknown option: %s\n", argv[i]);
+        return 1;
+    }
+    if (dist_build(&dist, msg_size) < 0) return 1;
+
+    signal(SIGPIPE, SIG_IGN);
+
+    int sfd = socket(AF_INET, SOCK_STREAM, 0);
+    if (sfd < 0) { perror("socket"); return 1; }
+
+    int opt = 1;
+    setsockopt(sfd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    if (bind(sfd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        close(sfd);
+        return 1;
+    }
+    if (listen(sfd, 128) < 0) {
+        perror("listen");
+        close(sfd);
+        return 1;
+    }
+
+    printf("[A5 Server] listening on port %d | msg_size=%d | duration=%ds | clients=%d | busy_poll=%d | dist=%s mean=%.1f\n",
+           port, msg_size, duration, num_clients, bp.enabled ? bp.usec : 0, dist.spec, dist.mean_size);
+    fflush(stdout);
+
+    pthread_t *tids = calloc((size_t)num_clients, sizeof(pthread_t));
+    if (!tids) { perror("calloc"); close(sfd); return 1; }
+
+    xsk_iface_t ifc;
+    memset(&ifc, 0, sizeof(ifc));
+    ifc.map_fd = ifc.prog_fd = ifc.link_fd = -1;
+
+    for (int i = 0; i < num_clients; i++) {
+        struct sockaddr_in caddr;
+        socklen_t clen = sizeof(caddr);
+
+        int cfd;
+        while (1) {
+            cfd = accept(sfd, (struct sockaddr *)&caddr, &clen);
+            if (cfd >= 0) break;
+            if (errno == EINTR) continue;
+            perror("accept");
+            num_clients = i;
+            goto join_and_exit;
+        }
+
+        // the first control connection tells us which interface carries the flows
+        if (ifc.link_fd < 0) {
+            if (xsk_iface_from_fd(cfd, &ifc) < 0 || xsk_iface_attach(&ifc, &xc) < 0) {
+                close(cfd);
+                num_clients = i;
+                goto join_and_exit;
+            }
+            printf("[A5 Server] XDP %s mode on %s | queues=%d | mtu=%d | payload/frame=%d\n",
+                   ifc.mode, ifc.name, ifc.nqueues, ifc.mtu, xsk_max_payload(&ifc));
+            fflush(stdout);
+        }
+
+        xsk_hello_t hello;
+        if (recv(cfd, &hello, sizeof(hello), MSG_WAITALL) != (ssize_t)sizeof(hello)) {
+            perror("recv(hello)");
+            close(cfd);
+            continue;
+        }
+        uint8_t peer_mac[ETH_ALEN];
+        memcpy(peer_mac, hello.mac, ETH_ALEN);
+
+        memset(&hello, 0, sizeof(hello));
+        hello.queue = (uint32_t)i;
+        hello.status = i < ifc.nqueues ? 0 : 1;
+        memcpy(hello.mac, ifc.mac, ETH_ALEN);
+        if (send(cfd, &hello, sizeof(hello), 0) != (ssize_t)sizeof(hello) || hello.status != 0) {
+            if (hello.status != 0)
+                fprintf(stderr, "flow %d: %s has only %d usable queues (%s mode)\n", i, ifc.name, ifc.nqueues, ifc.mode);
+            close(cfd);
+            continue;
+        }
+
+        flow_arg_t *arg = malloc(sizeof(*arg));
+        if (!arg) {
+            perror("malloc");
+            close(cfd);
+            num_clients = i;
+            goto join_and_exit;
+        }
+
+        arg->fd = cfd;
+        arg->flow = i;
+        arg->duration = duration;
+        arg->steer = cs.enabled;
+        arg->msg_size = msg_size;
+        arg->bp = &bp;
+        arg->dist = &dist;
+        arg->ifc = &ifc;
+        memcpy(arg->peer_mac, peer_mac, ETH_ALEN);
+
+        int rc = pthread_create(&tids[i], NULL, flow_worker, arg);
+        if (rc != 0) {
+            fprintf(stderr, "pthread_create: %s\n", strerror(rc));
+            close(cfd);
+            free(arg);
+            num_clients = i;
+            goto join_and_exit;
+        }
+    }
+
+join_and_exit:
+    close(sfd);
+    for (int i = 0; i < num_clients; i++) {
+        if (tids[i]) pthread_join(tids[i], NULL);
+    }
+    free(tids);
+    dist_free(&dist);
+    xsk_iface_detach(&ifc);
+
+    printf("SERVER_SUMMARY cpu_s=%.6f busy_poll=%d\n", cpu_sec_self(), bp.enabled ? bp.usec : 0);
+    return 0;
+}
@@ -0,0 +1,89 @@
+// MT25084_Part_A_BusyPoll.h
+// Optional busy-poll (spin) mode shared by the A1/A2/A3 servers and clients.
+// Enabled with the trailing option: --busy-poll[=<usec>]   (default 50 usec)
+//
+// When enabled:
+//  - every send()/recv() is issued with MSG_DONTWAIT and retried in a spin
+//    loop on EAGAIN, so the thread never sleeps in the kernel
+//  - SO_BUSY_POLL / SO_PREFER_BUSY_POLL / SO_BUSY_POLL_BUDGET are set on the
+//    data socket so the kernel polls the device queue instead of waiting
+//    for the softirq
+// CPU time (user+sys from getrusage) is reported so the latency gained can be
+// weighed against the CPU burned.
+
+#ifndef MT25084_PART_A_BUSYPOLL_H
+#define MT25084_PART_A_BUSYPOLL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+// older libc headers may not know the newer busy-poll options
+#ifndef SO_BUSY_POLL
+#define SO_BUSY_POLL 46
+#endif
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL 69
+#endif
+#ifndef SO_BUSY_POLL_BUDGET
+#define SO_BUSY_POLL_BUDGET 70
+#endif
+
+#define BUSY_POLL_DEFAULT_USEC 50
+#define BUSY_POLL_DEFAULT_BUDGET 64
+
+typedef struct {
+    int enabled;
+    int usec;   // SO_BUSY_POLL value
+    int budget; // SO_BUSY_POLL_BUDGET value
+} busy_poll_cfg_t;
+
+// Returns 1 if arg was a busy-poll option, 0 if not ours, -1 if malformed.
+static inline int busy_poll_parse_opt(const char *arg, busy_poll_cfg_t *cfg) {
+    if (strcmp(arg, "--busy-poll") == 0) {
+        cfg->enabled = 1;
+        cfg->usec = BUSY_POLL_DEFAULT_USEC;
+        cfg->budget = BUSY_POLL_DEFAULT_BUDGET;
+        return 1;
+    }
+    if (strncmp(arg, "--busy-poll=", 12) == 0) {
+        int usec = atoi(arg + 12);
+        if (usec <= 0) return -1;
+        cfg->enabled = 1;
+        cfg->usec = usec;
+        cfg->budget = BUSY_POLL_DEFAULT_BUDGET;
+        return 1;
+    }
+    return 0;
+}
+
+// MSG_DONTWAIT in spin mode, 0 (blocking) otherwise
+static inline int busy_poll_io_flags(const busy_poll_cfg_t *cfg) {
+    return cfg->enabled ? MSG_DONTWAIT : 0;
+}
+
+// Best effort: a kernel without SO_PREFER_BUSY_POLL (< 5.11) still spins in
+// user space, it just does not get the NAPI-side preference.
+static inline void busy_poll_apply(int fd, const busy_poll_cfg_t *cfg) {
+    if (!cfg->enabled) return;
+
+    int one = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &cfg->usec, sizeof(cfg->usec)) < 0)
+        perror("setsockopt(SO_BUSY_POLL)");
+    if (setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &one, sizeof(one)) < 0)
+        perror("setsockopt(SO_PREFER_BUSY_POLL)");
+    if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL_BUDGET, &cfg->budget, sizeof(cfg->budget)) < 0)
+        perror("setsockopt(SO_BUSY_POLL_BUDGET)");
+}
+
+// user+sys CPU seconds consumed by the whole process so far
+static inline double cpu_sec_self(void) {
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return 0.0;
+    return (double)ru.ru_utime.tv_sec + (double)ru.ru_utime.tv_usec / 1e6 +
+           (double)ru.ru_stime.tv_sec + (double)ru.ru_stime.tv_usec / 1e6;
+}
+
+#endif
@@ -0,0 +1,106 @@
+// MT25084_Part_A_CpuSteer.h
+// Optional connection-to-CPU steering shared by the servers and clients.
+// Enabled with the trailing option: --steer-cpu
+//
+// getsockopt(SO_INCOMING_CPU) returns the CPU whose softirq last processed a
+// packet of the connection (chosen by the veth queue / RPS / XPS setup of the
+// harness). The server starts each connection's worker pinned to that CPU; the
+// client pins itself once the first data has arrived. Protocol and application
+// processing of a flow then share one CPU (and its caches) instead of bouncing
+// between cores. One line per steered connection:
+//   STEER side=<srv|cli> conn=<client port> cpu=<n>
+
+#ifndef MT25084_PART_A_CPUSTEER_H
+#define MT25084_PART_A_CPUSTEER_H
+
+// needs _GNU_SOURCE (CPU_SET, pthread_*affinity_np) before the first system include
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#ifndef SO_INCOMING_CPU
+#define SO_INCOMING_CPU 49
+#endif
+
+typedef struct {
+    int enabled;
+    int pending; // client: not pinned yet
+} cpu_steer_cfg_t;
+
+// Returns 1 if arg was the steering option, 0 if not ours.
+static inline int cpu_steer_parse_opt(const char *arg, cpu_steer_cfg_t *cfg) {
+    if (strcmp(arg, "--steer-cpu") == 0) {
+        cfg->enabled = 1;
+        cfg->pending = 1;
+        return 1;
+    }
+    return 0;
+}
+
+// CPU that processed the connection's last incoming packet, -1 if unknown.
+static inline int cpu_steer_incoming(int fd) {
+    int cpu = -1;
+    socklen_t len = sizeof(cpu);
+    if (getsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len) < 0) return -1;
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return -1;
+    return cpu;
+}
+
+static void cpu_steer_log(const char *side, int fd, int cpu) {
+    struct sockaddr_in a;
+    socklen_t alen = sizeof(a);
+    memset(&a, 0, sizeof(a));
+    // conn = client port on both ends, as in the TCPINFO lines
+    if (strcmp(side, "srv") == 0) getpeername(fd, (struct sockaddr *)&a, &alen);
+    else getsockname(fd, (struct sockaddr *)&a, &alen);
+    printf("STEER side=%s conn=%d cpu=%d\n", side, ntohs(a.sin_port), cpu);
+    fflush(stdout);
+}
+
+// Server: prepare attr so the worker for fd starts on the fd's incoming CPU.
+// Returns 1 if attr was initialised (caller destroys it), 0 to use default attrs.
+static inline int cpu_steer_worker_attr(const cpu_steer_cfg_t *cfg, int fd, pthread_attr_t *attr) {
+    if (!cfg->enabled) return 0;
+    int cpu = cpu_steer_incoming(fd);
+    if (cpu < 0) return 0;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_attr_init(attr);
+    int rc = pthread_attr_setaffinity_np(attr, sizeof(set), &set);
+    if (rc != 0) {
+        fprintf(stderr, "pthread_attr_setaffinity_np: %s\n", strerror(rc));
+        pthread_attr_destroy(attr);
+        return 0;
+    }
+    cpu_steer_log("srv", fd, cpu);
+    return 1;
+}
+
+// Pins the calling thread to cpu. Returns 0 on success.
+static inline int cpu_steer_pin_to(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0) {
+        fprintf(stderr, "pthread_setaffinity_np: %s\n", strerror(rc));
+        return -1;
+    }
+    return 0;
+}
+
+// Client: call after a successful recv(); pins the calling thread once.
+static inline void cpu_steer_pin_self(cpu_steer_cfg_t *cfg, int fd) {
+    cfg->pending = 0;
+    int cpu = cpu_steer_incoming(fd);
+    if (cpu < 0) return;
+    if (cpu_steer_pin_to(cpu) == 0) cpu_steer_log("cli", fd, cpu);
+}
+
+#endif
@@ -0,0 +1,243 @@
+// MT25084_Part_A_Dist.h
+// Message-size distributions shared by the A1/A2/A3 servers and clients.
+// Selected with the trailing options:
+//   --dist=bimodal:<small>:<large>:<p_small>   two sizes, p_small = P(small)
+//   --dist=lognormal:<median>:<sigma>           median bytes, sigma of ln(size)
+//   --dist=cdf:<file>                           empirical CDF, lines "<size> <cum_prob>"
+//   --seed=<n>                                  table seed (default 1)
+// Without --dist every message is exactly msg_size bytes (original behaviour).
+// With --dist, msg_size is the upper bound: drawn sizes are clamped to [1, msg_size].
+//
+// Sizes are pre-generated into a DIST_TABLE_SIZE lookup table, so the hot loop
+// only does table[cursor++ & mask]. The table is fully determined by the spec
+// and seed, so a client given the same options regenerates the identical
+// sequence and can find message boundaries in the TCP byte stream without any
+// framing on the wire. This is what the per-size-bucket client report uses.
+
+#ifndef MT25084_PART_A_DIST_H
+#define MT25084_PART_A_DIST_H
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DIST_TABLE_BITS 16
+#define DIST_TABLE_SIZE (1u << DIST_TABLE_BITS)
+#define DIST_TABLE_MASK (DIST_TABLE_SIZE - 1u)
+#define DIST_CDF_MAX_POINTS 4096
+#define DIST_MAX_BUCKETS 32
+
+typedef struct {
+    int enabled;             // 0 => fixed msg_size
+    char spec[256];          // text after --dist=
+    unsigned long long seed;
+    int *table;              // DIST_TABLE_SIZE sizes, read-only once built
+    int max_size;
+    double mean_size;
+} msg_dist_t;
+
+// Returns 1 if arg was a distribution option, 0 if not ours, -1 if malformed.
+static inline int dist_parse_opt(const char *arg, msg_dist_t *d) {
+    if (strncmp(arg, "--dist=", 7) == 0) {
+        if (strlen(arg + 7) >= sizeof(d->spec)) return -1;
+        strcpy(d->spec, arg + 7);
+        d->enabled = 1;
+        return 1;
+    }
+    if (strncmp(arg, "--seed=", 7) == 0) {
+        d->seed = strtoull(arg + 7, NULL, 10);
+        return 1;
+    }
+    return 0;
+}
+
+// splitmix64: tiny, and identical on both ends for the same seed
+static inline unsigned long long dist_rng_next(unsigned long long *s) {
+    unsigned long long z = (*s += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// uniform in [0, 1)
+static inline double dist_rng_uniform(unsigned long long *s) {
+    return (double)(dist_rng_next(s) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static inline int dist_clamp(double v, int cap) {
+    if (v < 1.0) return 1;
+    if (v > (double)cap) return cap;
+    return (int)(v + 0.5);
+}
+
+static int dist_load_cdf(const char *path, int *sizes, double *cum, int *npoints) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    char line[256];
+    int n = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        int sz;
+        double p;
+        if (sscanf(line, "%d %lf", &sz, &p) != 2) continue;
+        if (n == DIST_CDF_MAX_POINTS) {
+            fprintf(stderr, "%s: more than %d CDF points\n", path, DIST_CDF_MAX_POINTS);
+            fclose(f);
+            return -1;
+        }
+        if (sz <= 0 || p < 0.0 || p > 1.0 || (n > 0 && p < cum[n - 1])) {
+            fprintf(stderr, "%s: bad CDF point '%s'\n", path, line);
+            fclose(f);
+            return -1;
+        }
+        sizes[n] = sz;
+        cum[n] = p;
+        n++;
+    }
+    fclose(f);
+    if (n == 0) {
+        fprintf(stderr, "%s: empty CDF\n", path);
+        return -1;
+    }
+    cum[n - 1] = 1.0; // tolerate rounding in the last point
+    *npoints = n;
+    return 0;
+}
+
+// Fills d->table. Returns 0 on success, -1 (after printing why) on error.
+static int dist_build(msg_dist_t *d, int msg_size) {
+    d->table = malloc(DIST_TABLE_SIZE * sizeof(int));
+    if (!d->table) {
+        perror("malloc");
+        return -1;
+    }
+    if (d->seed == 0) d->seed = 1;
+    unsigned long long rng = d->seed;
+
+    if (!d->enabled) {
+        strcpy(d->spec, "fixed");
+        for (unsigned i = 0; i < DIST_TABLE_SIZE; i++) d->table[i] = msg_size;
+    } else if (strncmp(d->spec, "bimodal:", 8) == 0) {
+        int small, large;
+        double p_small;
+        if (sscanf(d->spec + 8, "%d:%d:%lf", &small, &large, &p_small) != 3 ||
+            small <= 0 || large <= 0 || p_small < 0.0 || p_small > 1.0) {
+            fprintf(stderr, "bad bimodal spec: %s\n", d->spec);
+            goto fail;
+        }
+        for (unsigned i = 0; i < DIST_TABLE_SIZE; i++) {
+            int v = dist_rng_uniform(&rng) < p_small ? small : large;
+            d->table[i] = dist_clamp((double)v, msg_size);
+        }
+    } else if (strncmp(d->spec, "lognormal:", 10) == 0) {
+        double median, sigma;
+        if (sscanf(d->spec + 10, "%lf:%lf", &median, &sigma) != 2 || median <= 0.0 || sigma < 0.0) {
+            fprintf(stderr, "bad lognormal spec: %s\n", d->spec);
+            goto fail;
+        }
+        double mu = log(median);
+        for (unsigned i = 0; i < DIST_TABLE_SIZE; i++) {
+            // Box-Muller; 1-u keeps log() away from 0
+            double u1 = 1.0 - dist_rng_uniform(&rng);
+            double u2 = dist_rng_uniform(&rng);
+            double z = sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+            d->table[i] = dist_clamp(exp(mu + sigma * z), msg_size);
+        }
+    } else if (strncmp(d->spec, "cdf:", 4) == 0) {
+        static int sizes[DIST_CDF_MAX_POINTS];
+        static double cum[DIST_CDF_MAX_POINTS];
+        int n = 0;
+        if (dist_load_cdf(d->spec + 4, sizes, cum, &n) < 0) goto fail;
+        for (unsigned i = 0; i < DIST_TABLE_SIZE; i++) {
+            double u = dist_rng_uniform(&rng);
+            int lo = 0, hi = n - 1;
+            while (lo < hi) { // first point with cum >= u
+                int mid = (lo + hi) / 2;
+                if (cum[mid] >= u) hi = mid;
+                else lo = mid + 1;
+            }
+            d->table[i] = dist_clamp((double)sizes[lo], msg_size);
+        }
+    } else {
+        fprintf(stderr, "unknown distribution: %s\n", d->spec);
+        goto fail;
+    }
+
+    double sum = 0.0;
+    d->max_size = 0;
+    for (unsigned i = 0; i < DIST_TABLE_SIZE; i++) {
+        sum += d->table[i];
+        if (d->table[i] > d->max_size) d->max_size = d->table[i];
+    }
+    d->mean_size = sum / DIST_TABLE_SIZE;
+    return 0;
+
+fail:
+    free(d->table);
+    d->table = NULL;
+    return -1;
+}
+
+static inline int dist_next(const msg_dist_t *d, unsigned *cursor) {
+    return d->table[(*cursor)++ & DIST_TABLE_MASK];
+}
+
+static inline void dist_free(msg_dist_t *d) {
+    free(d->table);
+    d->table = NULL;
+}
+
+// bucket b holds sizes in (2^(b-1), 2^b]
+static inline int dist_bucket(int size) {
+    return size <= 1 ? 0 : 32 - __builtin_clz((unsigned)(size - 1));
+}
+
+typedef struct {
+    long long msgs;
+    long long bytes;
+} dist_bucket_t;
+
+// Receive-side tracker: walks the same size sequence as the sender
+typedef struct {
+    unsigned cursor;
+    int cur;       // size of the message being received
+    int remaining; // bytes still missing from it
+    dist_bucket_t buckets[DIST_MAX_BUCKETS];
+} dist_rx_t;
+
+static inline void dist_rx_init(dist_rx_t *rx, const msg_dist_t *d) {
+    memset(rx, 0, sizeof(*rx));
+    rx->cur = dist_next(d, &rx->cursor);
+    rx->remaining = rx->cur;
+}
+
+// account n freshly received bytes; a trailing partial message is not counted
+static inline void dist_rx_consume(dist_rx_t *rx, const msg_dist_t *d, long long n) {
+    while (n >= rx->remaining) {
+        n -= rx->remaining;
+        dist_bucket_t *b = &rx->buckets[dist_bucket(rx->cur)];
+        b->msgs += 1;
+        b->bytes += rx->cur;
+        rx->cur = dist_next(d, &rx->cursor);
+        rx->remaining = rx->cur;
+    }
+    rx->remaining -= (int)n;
+}
+
+static inline void dist_rx_print(const dist_rx_t *rx, double elapsed) {
+    for (int b = 0; b < DIST_MAX_BUCKETS; b++) {
+        const dist_bucket_t *k = &rx->buckets[b];
+        if (k->msgs == 0) continue;
+        // 64-bit bounds: hi of the top bucket (b = 31) does not fit in an int
+        long long lo = b == 0 ? 1 : (1LL << (b - 1)) + 1;
+        long long hi = 1LL << b;
+        double gbps = (elapsed > 0.0) ? ((double)k->bytes * 8.0) / (elapsed * 1e9) : 0.0;
+        printf("BUCKET lo=%lld hi=%lld msgs=%lld bytes=%lld gbps=%.6f\n", lo, hi, k->msgs, k->bytes, gbps);
+    }
+}
+
+#endif
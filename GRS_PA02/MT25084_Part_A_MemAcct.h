@@ -0,0 +1,293 @@
+// MT25084_Part_A_MemAcct.h
+// Per-connection memory accounting and the low-memory worker model shared by
+// the A1-A4 servers.
+// Trailing option: --lowmem[=<stack_kib>]   (default 64 KiB worker stacks)
+//
+// Thread-per-client costs every connection a worker stack (8 MiB reserved by
+// default), its socket buffers and a private payload buffer. With --lowmem the
+// workers get a small fixed stack and all connections send from one shared,
+// read-only payload mapping instead of a malloc each.
+//
+// The footprint is always reported. It is sampled once at mid-run (all workers
+// up, queues at steady state) and printed at the end of the run:
+//   MEMCONN conn=<client port> stack_committed_b=.. rmem_alloc=.. ... drops=..
+//   MEM mode=<default|lowmem> conns=.. rss_kib=.. ... bytes_per_conn=..
+// rss_*      VmRSS of the server (base = before the first accept)
+// stack_*    reserved = worker stack sizes, committed = resident pages of
+//            those stacks (mincore)
+// sock_mem   sum of rmem_alloc + wmem_queued + fwd_alloc from SO_MEMINFO
+// tcp_mem    /proc/net/sockstat "TCP: mem" (host-wide, all namespaces)
+// payload    private payload buffers (or the one shared buffer)
+
+#ifndef MT25084_PART_A_MEMACCT_H
+#define MT25084_PART_A_MEMACCT_H
+
+// needs _GNU_SOURCE (pthread_getattr_np) before the first system include
+#include <arpa/inet.h>
+#include <errno.h>
+#include <linux/sock_diag.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef SO_MEMINFO
+#define SO_MEMINFO 55
+#endif
+
+#define MEM_LOWMEM_STACK_KIB 64
+
+typedef struct {
+    int lowmem;
+    size_t stack_size;       // --lowmem worker stack
+    size_t payload_size;
+    char fill;
+    char *shared;            // --lowmem: one read-only payload for every connection
+    long long payload_bytes; // private payload buffers handed out (atomic)
+
+    int cap, n;
+    int *fds;                // dups, so SO_MEMINFO stays readable after the worker closes
+    int *conn;
+
+    // mid-run sample
+    int sampled;
+    long rss_base_kib, rss_kib;
+    long long stack_reserved, stack_committed, sock_mem, tcp_mem;
+    long long *conn_stack;
+    uint32_t (*meminfo)[SK_MEMINFO_VARS];
+} mem_acct_t;
+
+// Returns 1 if arg was the low-memory option, 0 if not ours, -1 if malformed.
+static inline int mem_acct_parse_opt(const char *arg, mem_acct_t *m) {
+    if (strcmp(arg, "--lowmem") == 0) {
+        m->lowmem = 1;
+        m->stack_size = (size_t)MEM_LOWMEM_STACK_KIB << 10;
+        return 1;
+    }
+    if (strncmp(arg, "--lowmem=", 9) == 0) {
+        int kib = atoi(arg + 9);
+        if (kib <= 0) return -1;
+        m->lowmem = 1;
+        m->stack_size = (size_t)kib << 10;
+        return 1;
+    }
+    return 0;
+}
+
+static long mem_rss_kib(void) {
+    FILE *f = fopen("/proc/self/status", "r");
+    if (!f) return 0;
+    char line[256];
+    long kib = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "VmRSS: %ld", &kib) == 1) break;
+    }
+    fclose(f);
+    return kib;
+}
+
+// "TCP: inuse .. orphan .. tw .. alloc .. mem <pages>" -> bytes
+static long long mem_tcp_sockstat(void) {
+    FILE *f = fopen("/proc/net/sockstat", "r");
+    if (!f) return 0;
+    char line[256];
+    long long pages = 0;
+    while (fgets(line, sizeof(line), f)) {
+        const char *p;
+        if (strncmp(line, "TCP:", 4) == 0 && (p = strstr(line, " mem ")) != NULL) {
+            pages = atoll(p + 5);
+            break;
+        }
+    }
+    fclose(f);
+    return pages * sysconf(_SC_PAGESIZE);
+}
+
+// Stack of a worker (running or exited, not yet joined): size and resident bytes.
+static void mem_thread_stack(pthread_t tid, long long *reserved, long long *committed) {
+    pthread_attr_t a;
+    void *addr;
+    size_t size;
+    *reserved = *committed = 0;
+    if (pthread_getattr_np(tid, &a) != 0) return;
+    int rc = pthread_attr_getstack(&a, &addr, &size);
+    pthread_attr_destroy(&a);
+    if (rc != 0) return;
+
+    long page = sysconf(_SC_PAGESIZE);
+    uintptr_t lo = (uintptr_t)addr & ~((uintptr_t)page - 1);
+    size_t len = (size_t)((uintptr_t)addr + size - lo);
+    size_t npages = (len + (size_t)page - 1) / (size_t)page;
+    unsigned char *vec = malloc(npages);
+    if (!vec) return;
+    *reserved = (long long)size;
+    if (mincore((void *)lo, len, vec) == 0) {
+        for (size_t i = 0; i < npages; i++) *committed += (vec[i] & 1) ? page : 0;
+    }
+    free(vec);
+}
+
+// After listen(): records the base RSS and, with --lowmem, builds the shared
+// payload. fill is the payload byte. Returns 0, or -1 on allocation failure.
+static inline int mem_acct_init(mem_acct_t *m, int payload_size, char fill, int max_conns) {
+    m->payload_size = (size_t)payload_size;
+    m->fill = fill;
+    m->cap = max_conns;
+    m->fds = calloc((size_t)max_conns, sizeof(int));
+    m->conn = calloc((size_t)max_conns, sizeof(int));
+    m->conn_stack = calloc((size_t)max_conns, sizeof(long long));
+    m->meminfo = calloc((size_t)max_conns, sizeof(*m->meminfo));
+    if (!m->fds || !m->conn || !m->conn_stack || !m->meminfo) {
+        perror("calloc");
+        return -1;
+    }
+
+    if (m->lowmem) {
+        long min = sysconf(_SC_THREAD_STACK_MIN);
+        if (min > 0 && m->stack_size < (size_t)min) m->stack_size = (size_t)min;
+
+        void *p = mmap(NULL, m->payload_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            perror("mmap(payload)");
+            return -1;
+        }
+        memset(p, fill, m->payload_size);
+        if (mprotect(p, m->payload_size, PROT_READ) < 0) {
+            perror("mprotect(payload)");
+            munmap(p, m->payload_size);
+            return -1;
+        }
+        m->shared = p;
+    }
+    m->rss_base_kib = mem_rss_kib();
+    return 0;
+}
+
+// Payload buffer for one connection (the shared one with --lowmem), NULL on failure.
+static inline char *mem_payload_get(mem_acct_t *m) {
+    if (m->shared) return m->shared;
+    char *buf = malloc(m->payload_size);
+    if (!buf) {
+        perror("malloc");
+        return NULL;
+    }
+    memset(buf, m->fill, m->payload_size);
+    __atomic_add_fetch(&m->payload_bytes, (long long)m->payload_size, __ATOMIC_RELAXED);
+    return buf;
+}
+
+static inline void mem_payload_put(const mem_acct_t *m, char *buf) {
+    if (buf != m->shared) free(buf);
+}
+
+// Adds the --lowmem stack size to the worker attrs. has_attr: attr is already
+// initialised (CPU steering). Returns 1 if attr is initialised (caller destroys it).
+static inline int mem_worker_attr(const mem_acct_t *m, pthread_attr_t *attr, int has_attr) {
+    if (!m->lowmem) return has_attr;
+    if (!has_attr) pthread_attr_init(attr);
+    int rc = pthread_attr_setstacksize(attr, m->stack_size);
+    if (rc != 0) fprintf(stderr, "pthread_attr_setstacksize: %s\n", strerror(rc));
+    return 1;
+}
+
+// Registers an accepted connection (main thread, before its worker starts).
+static inline void mem_acct_add(mem_acct_t *m, int fd) {
+    if (m->n >= m->cap) return;
+
+    struct sockaddr_in a;
+    socklen_t alen = sizeof(a);
+    memset(&a, 0, sizeof(a));
+    getpeername(fd, (struct sockaddr *)&a, &alen);
+
+    // slot i stays connection i even if dup fails, so it lines up with tids[i]
+    int dfd = dup(fd);
+    if (dfd < 0) perror("dup(memacct)");
+    m->fds[m->n] = dfd;
+    m->conn[m->n] = ntohs(a.sin_port);
+    m->n++;
+}
+
+// Main thread, after the accept loop: waits for mid-run, then samples.
+// tids[i] is the worker of the i-th registered connection. nthreads below the
+// init-time connection count means the accept loop bailed out on an error;
+// then, as with no connections at all, nothing is sampled (no MEM lines).
+static inline void mem_acct_sample(mem_acct_t *m, const struct timespec *start_ts, int duration,
+                                   const pthread_t *tids, int nthreads) {
+    if (m->n == 0 || nthreads < m->cap) return;
+
+    struct timespec mid = *start_ts;
+    mid.tv_sec += duration / 2;
+    if (duration % 2) mid.tv_nsec += 500000000L;
+    if (mid.tv_nsec >= 1000000000L) {
+        mid.tv_sec += 1;
+        mid.tv_nsec -= 1000000000L;
+    }
+    int rc;
+    while ((rc = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &mid, NULL)) == EINTR) {}
+    if (rc != 0) {
+        fprintf(stderr, "clock_nanosleep: %s\n", strerror(rc));
+        return;
+    }
+
+    m->rss_kib = mem_rss_kib();
+    m->tcp_mem = mem_tcp_sockstat();
+    for (int i = 0; i < nthreads && i < m->n; i++) {
+        long long reserved = 0;
+        if (tids[i]) mem_thread_stack(tids[i], &reserved, &m->conn_stack[i]);
+        m->stack_reserved += reserved;
+        m->stack_committed += m->conn_stack[i];
+    }
+    for (int i = 0; i < m->n; i++) {
+        socklen_t len = sizeof(m->meminfo[i]);
+        if (m->fds[i] < 0 || getsockopt(m->fds[i], SOL_SOCKET, SO_MEMINFO, m->meminfo[i], &len) < 0) continue;
+        m->sock_mem += (long long)m->meminfo[i][SK_MEMINFO_RMEM_ALLOC] +
+                       m->meminfo[i][SK_MEMINFO_WMEM_QUEUED] + m->meminfo[i][SK_MEMINFO_FWD_ALLOC];
+    }
+    m->sampled = 1;
+}
+
+// End of run: prints the mid-run sample and releases everything.
+static inline void mem_acct_report(mem_acct_t *m) {
+    if (m->sampled) {
+        for (int i = 0; i < m->n; i++) {
+            const uint32_t *mi = m->meminfo[i];
+            printf("MEMCONN conn=%d stack_committed_b=%lld rmem_alloc=%u rcvbuf=%u wmem_alloc=%u sndbuf=%u "
+                   "fwd_alloc=%u wmem_queued=%u optmem=%u backlog=%u drops=%u\n",
+                   m->conn[i], m->conn_stack[i], mi[SK_MEMINFO_RMEM_ALLOC], mi[SK_MEMINFO_RCVBUF],
+                   mi[SK_MEMINFO_WMEM_ALLOC], mi[SK_MEMINFO_SNDBUF], mi[SK_MEMINFO_FWD_ALLOC],
+                   mi[SK_MEMINFO_WMEM_QUEUED], mi[SK_MEMINFO_OPTMEM], mi[SK_MEMINFO_BACKLOG],
+                   mi[SK_MEMINFO_DROPS]);
+        }
+
+        long long payload = m->shared ? (long long)m->payload_size : m->payload_bytes;
+        long long n = m->n > 0 ? m->n : 1;
+        long long rss_delta = (long long)(m->rss_kib - m->rss_base_kib) << 10;
+        printf("MEM mode=%s conns=%d rss_base_kib=%ld rss_kib=%ld stack_reserved_kib=%lld "
+               "stack_committed_kib=%lld sock_mem_kib=%lld tcp_mem_kib=%lld payload_kib=%lld "
+               "rss_per_conn_b=%lld stack_per_conn_b=%lld sock_per_conn_b=%lld payload_per_conn_b=%lld "
+               "bytes_per_conn=%lld\n",
+               m->lowmem ? "lowmem" : "default", m->n, m->rss_base_kib, m->rss_kib,
+               m->stack_reserved >> 10, m->stack_committed >> 10, m->sock_mem >> 10, m->tcp_mem >> 10,
+               payload >> 10, rss_delta / n, m->stack_committed / n, m->sock_mem / n, payload / n,
+               (m->stack_committed + m->sock_mem + payload) / n);
+        fflush(stdout);
+    }
+
+    for (int i = 0; i < m->n; i++) {
+        if (m->fds[i] >= 0) close(m->fds[i]);
+    }
+    if (m->shared) munmap(m->shared, m->payload_size);
+    free(m->fds);
+    free(m->conn);
+    free(m->conn_stack);
+    free(m->meminfo);
+    memset(m, 0, sizeof(*m));
+}
+
+#endif
@@ -0,0 +1,47 @@
+// MT25084_Part_A_SockBuf.h
+// Optional socket buffer sizes shared by the servers and clients.
+// Trailing options: --sndbuf=<bytes> --rcvbuf=<bytes>   (default: kernel autotuning)
+//
+// Servers set them on the listening socket (accepted sockets inherit them),
+// clients before connect(), so the receive window scale is negotiated with the
+// requested size. Note that setting a size turns off kernel autotuning for that
+// direction. SO_*BUFFORCE is tried first so root can exceed net.core.*mem_max.
+
+#ifndef MT25084_PART_A_SOCKBUF_H
+#define MT25084_PART_A_SOCKBUF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+
+typedef struct {
+    int sndbuf; // 0 = leave to the kernel
+    int rcvbuf;
+} sockbuf_cfg_t;
+
+// Returns 1 if arg was a buffer option, 0 if not ours, -1 if malformed.
+static inline int sockbuf_parse_opt(const char *arg, sockbuf_cfg_t *cfg) {
+    if (strncmp(arg, "--sndbuf=", 9) == 0) {
+        cfg->sndbuf = atoi(arg + 9);
+        return cfg->sndbuf > 0 ? 1 : -1;
+    }
+    if (strncmp(arg, "--rcvbuf=", 9) == 0) {
+        cfg->rcvbuf = atoi(arg + 9);
+        return cfg->rcvbuf > 0 ? 1 : -1;
+    }
+    return 0;
+}
+
+static inline void sockbuf_apply(int fd, const sockbuf_cfg_t *cfg) {
+    if (cfg->sndbuf > 0 &&
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUFFORCE, &cfg->sndbuf, sizeof(cfg->sndbuf)) < 0 &&
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &cfg->sndbuf, sizeof(cfg->sndbuf)) < 0)
+        perror("setsockopt(SO_SNDBUF)");
+    if (cfg->rcvbuf > 0 &&
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &cfg->rcvbuf, sizeof(cfg->rcvbuf)) < 0 &&
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &cfg->rcvbuf, sizeof(cfg->rcvbuf)) < 0)
+        perror("setsockopt(SO_RCVBUF)");
+}
+
+#endif
@@ -0,0 +1,167 @@
+// MT25084_Part_A_TcpInfo.h
+// Periodic TCP_INFO sampling shared by the servers and clients.
+// Enabled with the trailing option: --tcpinfo[=<ms>]   (default every 100 ms)
+//
+// A side thread samples getsockopt(TCP_INFO) plus SIOCOUTQ/SIOCINQ for every
+// registered connection and prints one line per connection per tick:
+//   TCPINFO side=<srv|cli> conn=<client port> t=<s> rtt_us=.. cwnd=.. ...
+// conn is the client-side port on both ends, so server and client series of
+// the same connection can be joined. The data path is never touched: the
+// sampler works on its own dup() of each socket, so workers close their fd as
+// before and the sampler simply stops emitting once the connection has left
+// ESTABLISHED.
+
+#ifndef MT25084_PART_A_TCPINFO_H
+#define MT25084_PART_A_TCPINFO_H
+
+#include <arpa/inet.h>
+#include <linux/sockios.h>
+#include <linux/tcp.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TCPINFO_DEFAULT_MS 100
+#define TCPINFO_MAX_CONNS 1024
+
+// TCP_ESTABLISHED lives in <netinet/tcp.h>, which cannot be included next to
+// <linux/tcp.h> (both define struct tcphdr); the latter is needed for the
+// newer tcp_info fields (delivery rate, busy/limited times)
+#ifndef TCP_ESTABLISHED
+#define TCP_ESTABLISHED 1
+#endif
+
+typedef struct {
+    int enabled;
+    int interval_ms;
+    const char *side;    // "srv" or "cli"
+    int use_peer_port;   // srv: client port is the peer port
+    pthread_mutex_t lock;
+    int fds[TCPINFO_MAX_CONNS]; // sampler-owned dups
+    int conn[TCPINFO_MAX_CONNS];
+    int n;
+    int stop; // set by tcpinfo_stop(), polled by the sampler (atomic)
+    struct timespec t0;
+    pthread_t tid;
+} tcpinfo_sampler_t;
+
+// Returns 1 if arg was a TCP_INFO option, 0 if not ours, -1 if malformed.
+static inline int tcpinfo_parse_opt(const char *arg, tcpinfo_sampler_t *s) {
+    if (strcmp(arg, "--tcpinfo") == 0) {
+        s->enabled = 1;
+        s->interval_ms = TCPINFO_DEFAULT_MS;
+        return 1;
+    }
+    if (strncmp(arg, "--tcpinfo=", 10) == 0) {
+        int ms = atoi(arg + 10);
+        if (ms <= 0) return -1;
+        s->enabled = 1;
+        s->interval_ms = ms;
+        return 1;
+    }
+    return 0;
+}
+
+static void tcpinfo_sample_one(tcpinfo_sampler_t *s, int fd, int conn, double t) {
+    struct tcp_info ti;
+    socklen_t len = sizeof(ti);
+    memset(&ti, 0, sizeof(ti)); // older kernels fill a prefix only
+    if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, &ti, &len) < 0) return;
+    if (ti.tcpi_state != TCP_ESTABLISHED) return;
+
+    int outq = 0, inq = 0;
+    ioctl(fd, SIOCOUTQ, &outq);
+    ioctl(fd, SIOCINQ, &inq);
+
+    printf("TCPINFO side=%s conn=%d t=%.3f rtt_us=%u rttvar_us=%u cwnd=%u ssthresh=%u "
+           "snd_wnd=%u rcv_space=%u rcv_ssthresh=%u unacked=%u retrans=%u total_retrans=%u "
+           "delivery_rate_Bps=%llu busy_us=%llu rwnd_limited_us=%llu sndbuf_limited_us=%llu "
+           "notsent=%u outq=%d inq=%d\n",
+           s->side, conn, t, ti.tcpi_rtt, ti.tcpi_rttvar, ti.tcpi_snd_cwnd, ti.tcpi_snd_ssthresh,
+           ti.tcpi_snd_wnd, ti.tcpi_rcv_space, ti.tcpi_rcv_ssthresh, ti.tcpi_unacked,
+           ti.tcpi_retrans, ti.tcpi_total_retrans,
+           (unsigned long long)ti.tcpi_delivery_rate, (unsigned long long)ti.tcpi_busy_time,
+           (unsigned long long)ti.tcpi_rwnd_limited, (unsigned long long)ti.tcpi_sndbuf_limited,
+           ti.tcpi_notsent_bytes, outq, inq);
+}
+
+static void *tcpinfo_thread(void *vp) {
+    tcpinfo_sampler_t *s = (tcpinfo_sampler_t *)vp;
+    struct timespec tick = { s->interval_ms / 1000, (long)(s->interval_ms % 1000) * 1000000L };
+
+    while (!__atomic_load_n(&s->stop, __ATOMIC_ACQUIRE)) {
+        nanosleep(&tick, NULL);
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        double t = (double)(now.tv_sec - s->t0.tv_sec) + (double)(now.tv_nsec - s->t0.tv_nsec) / 1e9;
+
+        pthread_mutex_lock(&s->lock);
+        for (int i = 0; i < s->n; i++) tcpinfo_sample_one(s, s->fds[i], s->conn[i], t);
+        pthread_mutex_unlock(&s->lock);
+        fflush(stdout);
+    }
+    return NULL;
+}
+
+// side: "srv" or "cli". No-op unless --tcpinfo was given.
+static inline int tcpinfo_start(tcpinfo_sampler_t *s, const char *side) {
+    if (!s->enabled) return 0;
+    s->side = side;
+    s->use_peer_port = strcmp(side, "srv") == 0;
+    s->n = 0;
+    s->stop = 0;
+    pthread_mutex_init(&s->lock, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &s->t0);
+
+    int rc = pthread_create(&s->tid, NULL, tcpinfo_thread, s);
+    if (rc != 0) {
+        fprintf(stderr, "pthread_create(tcpinfo): %s\n", strerror(rc));
+        s->enabled = 0;
+        return -1;
+    }
+    return 0;
+}
+
+static inline void tcpinfo_add(tcpinfo_sampler_t *s, int fd) {
+    if (!s->enabled) return;
+
+    struct sockaddr_in a;
+    socklen_t alen = sizeof(a);
+    memset(&a, 0, sizeof(a));
+    if (s->use_peer_port) getpeername(fd, (struct sockaddr *)&a, &alen);
+    else getsockname(fd, (struct sockaddr *)&a, &alen);
+
+    int dfd = dup(fd);
+    if (dfd < 0) {
+        perror("dup(tcpinfo)");
+        return;
+    }
+
+    pthread_mutex_lock(&s->lock);
+    if (s->n < TCPINFO_MAX_CONNS) {
+        s->fds[s->n] = dfd;
+        s->conn[s->n] = ntohs(a.sin_port);
+        s->n++;
+        dfd = -1;
+    }
+    pthread_mutex_unlock(&s->lock);
+    if (dfd >= 0) close(dfd);
+}
+
+static inline void tcpinfo_stop(tcpinfo_sampler_t *s) {
+    if (!s->enabled) return;
+    __atomic_store_n(&s->stop, 1, __ATOMIC_RELEASE);
+    pthread_join(s->tid, NULL);
+    for (int i = 0; i < s->n; i++) close(s->fds[i]);
+    s->n = 0;
+    pthread_mutex_destroy(&s->lock);
+}
+
+#endif
@@ -0,0 +1,473 @@
+// MT25084_Part_A_Xsk.h
+// AF_XDP plumbing shared by the A5 server and client (no libbpf/libxdp).
+//
+//  - a 15-instruction XDP program, loaded through the bpf() syscall, redirects
+//    frames with ethertype XSK_ETH_P to the AF_XDP socket registered for the
+//    frame's RX queue (XSKMAP) and passes everything else (ARP, the TCP
+//    control connection) to the kernel stack. It is attached with a BPF link,
+//    so it is detached automatically when the process exits.
+//  - every flow owns one socket bound to one veth queue, with one UMEM shared
+//    by its four rings: the first half of the frames cycles through the fill
+//    and RX rings, the second half through the TX and completion rings.
+//    Ring updates are batched (XSK_BATCH descriptors per producer/consumer
+//    index update).
+//  - framing: Ethernet header + xsk_hdr_t. DATA frames carry a per-flow frame
+//    sequence number and the message they belong to; a message larger than
+//    the MTU spans several frames, the first one flagged XSK_F_FIRST and the
+//    last one XSK_F_LAST (a one-frame message carries both). The
+//    receiver returns a cumulative ACK (next expected sequence) every
+//    XSK_ACK_EVERY frames; the sender keeps at most XSK_WINDOW frames
+//    unacknowledged. Lost frames are counted, not retransmitted.
+// Trailing option: --xdp-mode=drv|skb   (default drv = native veth XDP,
+// falls back to skb = generic XDP if the driver attach fails). Generic XDP on
+// veth reports every frame on RX queue 0, so skb mode carries a single flow.
+
+#ifndef MT25084_PART_A_XSK_H
+#define MT25084_PART_A_XSK_H
+
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <errno.h>
+#include <ifaddrs.h>
+#include <linux/bpf.h>
+#include <linux/if_ether.h>
+#include <linux/if_link.h>
+#include <linux/if_xdp.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef AF_XDP
+#define AF_XDP 44
+#endif
+#ifndef SOL_XDP
+#define SOL_XDP 283
+#endif
+
+#define XSK_ETH_P 0x88B5       // IEEE 802 local experimental ethertype
+#define XSK_FRAME_SIZE 2048
+#define XSK_NUM_FRAMES 4096    // half RX (fill ring), half TX
+#define XSK_RING_SIZE 2048
+#define XSK_BATCH 64
+#define XSK_WINDOW 1024        // unacked DATA frames per flow, < peer RX ring
+#define XSK_ACK_EVERY 64
+#define XSK_STALL_MS 20        // window full and no ACK for this long => count a stall, reopen
+#define XSK_RX_HEADROOM 256    // XDP_PACKET_HEADROOM in front of received frames
+
+enum { XSK_T_DATA = 1, XSK_T_ACK = 2 };
+#define XSK_F_LAST 1u
+#define XSK_F_FIRST 2u
+
+typedef struct {
+    uint32_t flow;
+    uint16_t type;
+    uint16_t flags;
+    uint64_t seq;     // DATA: frame sequence, ACK: next expected frame
+    uint32_t msg_len; // DATA: length of the message this frame belongs to
+    uint32_t len;     // payload bytes in this frame
+} __attribute__((packed)) xsk_hdr_t;
+
+#define XSK_HDR_LEN (ETH_HLEN + (int)sizeof(xsk_hdr_t))
+
+// Exchanged once per flow over the TCP control connection.
+typedef struct {
+    uint32_t queue;  // srv -> cli: queue (= flow id) to bind
+    uint32_t status; // srv -> cli: 0 ok, 1 no free queue
+    uint8_t mac[ETH_ALEN];
+    uint8_t pad[2];
+} xsk_hello_t;
+
+typedef struct {
+    int skb_mode; // 1 = generic XDP only
+} xsk_cfg_t;
+
+// Returns 1 if arg was an XDP option, 0 if not ours, -1 if malformed.
+static inline int xsk_parse_opt(const char *arg, xsk_cfg_t *cfg) {
+    if (strcmp(arg, "--xdp-mode=drv") == 0) { cfg->skb_mode = 0; return 1; }
+    if (strcmp(arg, "--xdp-mode=skb") == 0) { cfg->skb_mode = 1; return 1; }
+    if (strncmp(arg, "--xdp-mode=", 11) == 0) return -1;
+    return 0;
+}
+
+// ---------------- interface + XDP program ----------------
+
+typedef struct {
+    char name[IF_NAMESIZE];
+    int ifindex;
+    int nqueues;  // usable queues = max flows
+    int mtu;
+    uint8_t mac[ETH_ALEN];
+    int map_fd;
+    int prog_fd;
+    int link_fd;
+    const char *mode; // "drv" or "skb" once attached
+} xsk_iface_t;
+
+static inline long xsk_bpf(int cmd, union bpf_attr *attr) {
+    return syscall(__NR_bpf, cmd, attr, sizeof(*attr));
+}
+
+static int xsk_count_queues(const char *ifname) {
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/class/net/%s/queues", ifname);
+    DIR *d = opendir(path);
+    if (!d) return 1;
+    int rx = 0, tx = 0;
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL) {
+        if (strncmp(e->d_name, "rx-", 3) == 0) rx++;
+        if (strncmp(e->d_name, "tx-", 3) == 0) tx++;
+    }
+    closedir(d);
+    int n = rx < tx ? rx : tx;
+    return n > 0 ? n : 1;
+}
+
+// Finds the interface that carries fd's local address (veth_srv / veth_cli).
+static int xsk_iface_from_fd(int fd, xsk_iface_t *ifc) {
+    struct sockaddr_in a;
+    socklen_t alen = sizeof(a);
+    if (getsockname(fd, (struct sockaddr *)&a, &alen) < 0) { perror("getsockname"); return -1; }
+
+    struct ifaddrs *ifa, *p;
+    if (getifaddrs(&ifa) < 0) { perror("getifaddrs"); return -1; }
+    ifc->name[0] = '\0';
+    for (p = ifa; p; p = p->ifa_next) {
+        if (!p->ifa_addr || p->ifa_addr->sa_family != AF_INET) continue;
+        if (((struct sockaddr_in *)p->ifa_addr)->sin_addr.s_addr == a.sin_addr.s_addr) {
+            snprintf(ifc->name, sizeof(ifc->name), "%s", p->ifa_name);
+            break;
+        }
+    }
+    freeifaddrs(ifa);
+    if (ifc->name[0] == '\0') {
+        fprintf(stderr, "no interface has address %s\n", inet_ntoa(a.sin_addr));
+        return -1;
+    }
+
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    snprintf(ifr.ifr_name, sizeof(ifr.ifr_name), "%s", ifc->name);
+    if (ioctl(fd, SIOCGIFHWADDR, &ifr) < 0) { perror("ioctl(SIOCGIFHWADDR)"); return -1; }
+    memcpy(ifc->mac, ifr.ifr_hwaddr.sa_data, ETH_ALEN);
+    if (ioctl(fd, SIOCGIFMTU, &ifr) < 0) { perror("ioctl(SIOCGIFMTU)"); return -1; }
+    ifc->mtu = ifr.ifr_mtu;
+
+    ifc->ifindex = (int)if_nametoindex(ifc->name);
+    ifc->nqueues = xsk_count_queues(ifc->name);
+    return 0;
+}
+
+static int xsk_prog_load(int map_fd) {
+    // r2 = ctx->data, r3 = ctx->data_end
+    // if (r2 + 14 > r3 || eth->h_proto != XSK_ETH_P) return XDP_PASS
+    // return bpf_redirect_map(&xsks, ctx->rx_queue_index, XDP_PASS)
+    struct bpf_insn insns[] = {
+        { BPF_LDX | BPF_MEM | BPF_W, 2, 1, 0, 0 },
+        { BPF_LDX | BPF_MEM | BPF_W, 3, 1, 4, 0 },
+        { BPF_ALU64 | BPF_MOV | BPF_X, 4, 2, 0, 0 },
+        { BPF_ALU64 | BPF_ADD | BPF_K, 4, 0, 0, ETH_HLEN },
+        { BPF_JMP | BPF_JGT | BPF_X, 4, 3, 8, 0 },               // -> pass
+        { BPF_LDX | BPF_MEM | BPF_H, 5, 2, 12, 0 },
+        { BPF_JMP | BPF_JNE | BPF_K, 5, 0, 6, htons(XSK_ETH_P) }, // -> pass
+        { BPF_LDX | BPF_MEM | BPF_W, 2, 1, 16, 0 },
+        { BPF_LD | BPF_DW | BPF_IMM, 1, BPF_PSEUDO_MAP_FD, 0, map_fd },
+        { 0, 0, 0, 0, 0 },
+        { BPF_ALU64 | BPF_MOV | BPF_K, 3, 0, 0, XDP_PASS },
+        { BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map },
+        { BPF_JMP | BPF_EXIT, 0, 0, 0, 0 },
+        { BPF_ALU64 | BPF_MOV | BPF_K, 0, 0, 0, XDP_PASS },      // pass:
+        { BPF_JMP | BPF_EXIT, 0, 0, 0, 0 },
+    };
+    static char log[8192];
+
+    union bpf_attr a;
+    memset(&a, 0, sizeof(a));
+    a.prog_type = BPF_PROG_TYPE_XDP;
+    a.expected_attach_type = BPF_XDP;
+    a.insns = (uint64_t)(uintptr_t)insns;
+    a.insn_cnt = sizeof(insns) / sizeof(insns[0]);
+    a.license = (uint64_t)(uintptr_t)"GPL";
+    int fd = (int)xsk_bpf(BPF_PROG_LOAD, &a);
+    if (fd >= 0) return fd;
+
+    // again with the verifier log, for the error message
+    a.log_buf = (uint64_t)(uintptr_t)log;
+    a.log_size = sizeof(log);
+    a.log_level = 1;
+    fd = (int)xsk_bpf(BPF_PROG_LOAD, &a);
+    if (fd < 0) fprintf(stderr, "BPF_PROG_LOAD: %s\n%s\n", strerror(errno), log);
+    return fd;
+}
+
+// Creates the XSKMAP + program and attaches it to ifc (drv, else skb mode).
+static int xsk_iface_attach(xsk_iface_t *ifc, const xsk_cfg_t *cfg) {
+    union bpf_attr a;
+    memset(&a, 0, sizeof(a));
+    a.map_type = BPF_MAP_TYPE_XSKMAP;
+    a.key_size = sizeof(uint32_t);
+    a.value_size = sizeof(uint32_t);
+    a.max_entries = (uint32_t)ifc->nqueues;
+    ifc->map_fd = (int)xsk_bpf(BPF_MAP_CREATE, &a);
+    if (ifc->map_fd < 0) { perror("BPF_MAP_CREATE(XSKMAP)"); return -1; }
+
+    ifc->prog_fd = xsk_prog_load(ifc->map_fd);
+    if (ifc->prog_fd < 0) return -1;
+
+    for (int skb = cfg->skb_mode; skb <= 1; skb++) {
+        memset(&a, 0, sizeof(a));
+        a.link_create.prog_fd = (uint32_t)ifc->prog_fd;
+        a.link_create.target_ifindex = (uint32_t)ifc->ifindex;
+        a.link_create.attach_type = BPF_XDP;
+        a.link_create.flags = skb ? XDP_FLAGS_SKB_MODE : XDP_FLAGS_DRV_MODE;
+        ifc->link_fd = (int)xsk_bpf(BPF_LINK_CREATE, &a);
+        if (ifc->link_fd >= 0) {
+            ifc->mode = skb ? "skb" : "drv";
+            if (skb) ifc->nqueues = 1; // see above: only queue 0 is reachable
+            return 0;
+        }
+        fprintf(stderr, "XDP attach (%s mode) on %s: %s\n", skb ? "skb" : "drv", ifc->name, strerror(errno));
+    }
+    return -1;
+}
+
+static inline void xsk_iface_detach(xsk_iface_t *ifc) {
+    if (ifc->link_fd > 0) close(ifc->link_fd);
+    if (ifc->prog_fd > 0) close(ifc->prog_fd);
+    if (ifc->map_fd > 0) close(ifc->map_fd);
+    ifc->link_fd = ifc->prog_fd = ifc->map_fd = -1;
+}
+
+// ---------------- rings ----------------
+
+typedef struct {
+    uint32_t cached_prod;
+    uint32_t cached_cons; // producer rings: consumer + size
+    uint32_t mask;
+    uint32_t size;
+    uint32_t *producer;
+    uint32_t *consumer;
+    uint32_t *flags;
+    void *ring;
+    void *map;
+    size_t map_len;
+} xsk_ring_t;
+
+static inline uint64_t *xsk_ring_addr(xsk_ring_t *r, uint32_t idx) {
+    return &((uint64_t *)r->ring)[idx & r->mask];
+}
+
+static inline struct xdp_desc *xsk_ring_desc(xsk_ring_t *r, uint32_t idx) {
+    return &((struct xdp_desc *)r->ring)[idx & r->mask];
+}
+
+// producer side: reserve up to n slots, returns how many, *idx = first
+static inline uint32_t xsk_prod_reserve(xsk_ring_t *r, uint32_t n, uint32_t *idx) {
+    uint32_t free = r->cached_cons - r->cached_prod;
+    if (free < n) {
+        r->cached_cons = __atomic_load_n(r->consumer, __ATOMIC_ACQUIRE) + r->size;
+        free = r->cached_cons - r->cached_prod;
+    }
+    if (n > free) n = free;
+    *idx = r->cached_prod;
+    r->cached_prod += n;
+    return n;
+}
+
+static inline void xsk_prod_submit(xsk_ring_t *r) {
+    __atomic_store_n(r->producer, r->cached_prod, __ATOMIC_RELEASE);
+}
+
+// consumer side: peek up to n entries, returns how many, *idx = first
+static inline uint32_t xsk_cons_peek(xsk_ring_t *r, uint32_t n, uint32_t *idx) {
+    uint32_t avail = r->cached_prod - r->cached_cons;
+    if (avail == 0) {
+        r->cached_prod = __atomic_load_n(r->producer, __ATOMIC_ACQUIRE);
+        avail = r->cached_prod - r->cached_cons;
+    }
+    if (n > avail) n = avail;
+    *idx = r->cached_cons;
+    r->cached_cons += n;
+    return n;
+}
+
+static inline void xsk_cons_release(xsk_ring_t *r) {
+    __atomic_store_n(r->consumer, r->cached_cons, __ATOMIC_RELEASE);
+}
+
+static int xsk_ring_map(int fd, xsk_ring_t *r, const struct xdp_ring_offset *off,
+                        off_t pgoff, size_t entsize, int producer_ring) {
+    r->map_len = off->desc + XSK_RING_SIZE * entsize;
+    r->map = mmap(NULL, r->map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, pgoff);
+    if (r->map == MAP_FAILED) { r->map = NULL; perror("mmap(xsk ring)"); return -1; }
+    r->producer = (uint32_t *)((char *)r->map + off->producer);
+    r->consumer = (uint32_t *)((char *)r->map + off->consumer);
+    r->flags = (uint32_t *)((char *)r->map + off->flags);
+    r->ring = (char *)r->map + off->desc;
+    r->mask = XSK_RING_SIZE - 1;
+    r->size = XSK_RING_SIZE;
+    r->cached_prod = *r->producer;
+    r->cached_cons = *r->consumer + (producer_ring ? r->size : 0);
+    return 0;
+}
+
+// ---------------- socket ----------------
+
+typedef struct {
+    int fd;
+    int queue;
+    uint8_t *umem;
+    size_t umem_len;
+    xsk_ring_t fill, comp, rx, tx;
+    uint64_t free_tx[XSK_NUM_FRAMES / 2]; // TX frames not in flight
+    uint32_t nfree_tx;
+} xsk_sock_t;
+
+// Opens a socket on ifc queue q, primes the fill ring, pre-builds the Ethernet
+// header (src -> dst) in every TX frame and registers the socket in the XSKMAP.
+static int xsk_open(xsk_sock_t *xs, const xsk_iface_t *ifc, int q, const uint8_t *dst_mac) {
+    xs->queue = q;
+    xs->fd = socket(AF_XDP, SOCK_RAW, 0);
+    if (xs->fd < 0) { perror("socket(AF_XDP)"); return -1; }
+
+    xs->umem_len = (size_t)XSK_NUM_FRAMES * XSK_FRAME_SIZE;
+    xs->umem = mmap(NULL, xs->umem_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (xs->umem == MAP_FAILED) { xs->umem = NULL; perror("mmap(umem)"); return -1; }
+
+    struct xdp_umem_reg mr;
+    memset(&mr, 0, sizeof(mr));
+    mr.addr = (uint64_t)(uintptr_t)xs->umem;
+    mr.len = xs->umem_len;
+    mr.chunk_size = XSK_FRAME_SIZE;
+    if (setsockopt(xs->fd, SOL_XDP, XDP_UMEM_REG, &mr, sizeof(mr)) < 0) { perror("setsockopt(XDP_UMEM_REG)"); return -1; }
+
+    int n = XSK_RING_SIZE;
+    if (setsockopt(xs->fd, SOL_XDP, XDP_UMEM_FILL_RING, &n, sizeof(n)) < 0 ||
+        setsockopt(xs->fd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &n, sizeof(n)) < 0 ||
+        setsockopt(xs->fd, SOL_XDP, XDP_RX_RING, &n, sizeof(n)) < 0 ||
+        setsockopt(xs->fd, SOL_XDP, XDP_TX_RING, &n, sizeof(n)) < 0) {
+        perror("setsockopt(XDP ring size)");
+        return -1;
+    }
+
+    struct xdp_mmap_offsets off;
+    socklen_t olen = sizeof(off);
+    if (getsockopt(xs->fd, SOL_XDP, XDP_MMAP_OFFSETS, &off, &olen) < 0) { perror("getsockopt(XDP_MMAP_OFFSETS)"); return -1; }
+
+    if (xsk_ring_map(xs->fd, &xs->fill, &off.fr, XDP_UMEM_PGOFF_FILL_RING, sizeof(uint64_t), 1) < 0 ||
+        xsk_ring_map(xs->fd, &xs->comp, &off.cr, XDP_UMEM_PGOFF_COMPLETION_RING, sizeof(uint64_t), 0) < 0 ||
+        xsk_ring_map(xs->fd, &xs->rx, &off.rx, XDP_PGOFF_RX_RING, sizeof(struct xdp_desc), 0) < 0 ||
+        xsk_ring_map(xs->fd, &xs->tx, &off.tx, XDP_PGOFF_TX_RING, sizeof(struct xdp_desc), 1) < 0)
+        return -1;
+
+    struct sockaddr_xdp sx;
+    memset(&sx, 0, sizeof(sx));
+    sx.sxdp_family = AF_XDP;
+    sx.sxdp_ifindex = (uint32_t)ifc->ifindex;
+    sx.sxdp_queue_id = (uint32_t)q;
+    sx.sxdp_flags = XDP_COPY | XDP_USE_NEED_WAKEUP; // veth has no zero-copy mode
+    if (bind(xs->fd, (struct sockaddr *)&sx, sizeof(sx)) < 0) { perror("bind(AF_XDP)"); return -1; }
+
+    // RX half of the UMEM goes to the kernel up front
+    uint32_t idx, half = XSK_NUM_FRAMES / 2;
+    if (xsk_prod_reserve(&xs->fill, half, &idx) != half) { fprintf(stderr, "fill ring too small\n"); return -1; }
+    for (uint32_t i = 0; i < half; i++) *xsk_ring_addr(&xs->fill, idx + i) = (uint64_t)i * XSK_FRAME_SIZE;
+    xsk_prod_submit(&xs->fill);
+
+    // TX half: Ethernet header written once; the sender copies each payload in
+    xs->nfree_tx = 0;
+    for (uint32_t i = half; i < XSK_NUM_FRAMES; i++) {
+        uint64_t addr = (uint64_t)i * XSK_FRAME_SIZE;
+        struct ethhdr *eth = (struct ethhdr *)(xs->umem + addr);
+        memcpy(eth->h_dest, dst_mac, ETH_ALEN);
+        memcpy(eth->h_source, ifc->mac, ETH_ALEN);
+        eth->h_proto = htons(XSK_ETH_P);
+        xs->free_tx[xs->nfree_tx++] = addr;
+    }
+
+    union bpf_attr a;
+    uint32_t key = (uint32_t)q, val = (uint32_t)xs->fd;
+    memset(&a, 0, sizeof(a));
+    a.map_fd = (uint32_t)ifc->map_fd;
+    a.key = (uint64_t)(uintptr_t)&key;
+    a.value = (uint64_t)(uintptr_t)&val;
+    a.flags = BPF_ANY;
+    if (xsk_bpf(BPF_MAP_UPDATE_ELEM, &a) < 0) { perror("BPF_MAP_UPDATE_ELEM(XSKMAP)"); return -1; }
+    return 0;
+}
+
+static inline void xsk_close(xsk_sock_t *xs) {
+    xsk_ring_t *rings[4] = { &xs->fill, &xs->comp, &xs->rx, &xs->tx };
+    for (int i = 0; i < 4; i++)
+        if (rings[i]->map) munmap(rings[i]->map, rings[i]->map_len);
+    if (xs->fd >= 0) close(xs->fd);
+    if (xs->umem) munmap(xs->umem, xs->umem_len);
+}
+
+// largest payload per frame on this interface
+static inline int xsk_max_payload(const xsk_iface_t *ifc) {
+    int room = ifc->mtu;
+    if (room > XSK_FRAME_SIZE - XSK_RX_HEADROOM - ETH_HLEN) room = XSK_FRAME_SIZE - XSK_RX_HEADROOM - ETH_HLEN;
+    return room - (int)sizeof(xsk_hdr_t);
+}
+
+// In copy mode every TX descriptor is sent from the sendto() path.
+static inline void xsk_kick_tx(xsk_sock_t *xs) {
+    if (!(*xs->tx.flags & XDP_RING_NEED_WAKEUP)) return;
+    // EAGAIN/EBUSY/ENOBUFS just mean "kick again later"
+    sendto(xs->fd, NULL, 0, MSG_DONTWAIT, NULL, 0);
+}
+
+// returns completed TX frames to the free list
+static inline void xsk_reap_tx(xsk_sock_t *xs) {
+    uint32_t idx, n = xsk_cons_peek(&xs->comp, XSK_RING_SIZE, &idx);
+    if (n == 0) return;
+    for (uint32_t i = 0; i < n; i++) xs->free_tx[xs->nfree_tx++] = *xsk_ring_addr(&xs->comp, idx + i);
+    xsk_cons_release(&xs->comp);
+}
+
+// hands n received frames (rx descriptors idx..idx+n-1) back to the fill ring
+static inline void xsk_recycle_rx(xsk_sock_t *xs, uint32_t idx, uint32_t n) {
+    uint32_t fidx;
+    uint32_t got = xsk_prod_reserve(&xs->fill, n, &fidx); // never short: these frames came from it
+    for (uint32_t i = 0; i < got; i++)
+        *xsk_ring_addr(&xs->fill, fidx + i) = xsk_ring_desc(&xs->rx, idx + i)->addr & ~(uint64_t)(XSK_FRAME_SIZE - 1);
+    xsk_prod_submit(&xs->fill);
+    xsk_cons_release(&xs->rx);
+}
+
+static inline xsk_hdr_t *xsk_frame_hdr(xsk_sock_t *xs, uint64_t addr) {
+    return (xsk_hdr_t *)(xs->umem + addr + ETH_HLEN);
+}
+
+// queues one ACK frame (cumulative: next expected sequence); 0 if no TX slot
+static inline int xsk_send_ack(xsk_sock_t *xs, uint32_t flow, uint64_t next_seq) {
+    xsk_reap_tx(xs);
+    uint32_t idx;
+    if (xs->nfree_tx == 0 || xsk_prod_reserve(&xs->tx, 1, &idx) != 1) return 0;
+    uint64_t addr = xs->free_tx[--xs->nfree_tx];
+    xsk_hdr_t *h = xsk_frame_hdr(xs, addr);
+    h->flow = flow;
+    h->type = XSK_T_ACK;
+    h->flags = 0;
+    h->seq = next_seq;
+    h->msg_len = 0;
+    h->len = 0;
+    struct xdp_desc *d = xsk_ring_desc(&xs->tx, idx);
+    d->addr = addr;
+    d->len = XSK_HDR_LEN;
+    d->options = 0;
+    xsk_prod_submit(&xs->tx);
+    xsk_kick_tx(xs);
+    return 1;
+}
+
+#endif
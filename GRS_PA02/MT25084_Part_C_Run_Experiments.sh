@@ -4,12 +4,16 @@ set -euo pipefail
 # ----------------------------
 # MT25084 Part C Experiment Runner
 # ----------------------------
-# Runs A1/A2/A3 across message sizes and thread counts
+# Runs A1/A2/A3/A4/A5 across message sizes, thread counts and poll modes,
+# then across message-size mixes (see MT25084_Part_A_Dist.h)
 # Collects:
 #  - perf stat counters into MT25084_Part_C_raw_*_perf.csv
 #  - client logs into MT25084_Part_C_raw_*_clientX.log
 # Produces:
 #  - MT25084_Part_C_results.csv
+#  - MT25084_Part_C_buckets.csv (per-size-bucket throughput of the mix runs)
+#  - MT25084_Part_C_tcpinfo.csv (per-connection TCP_INFO time series, both sides)
+#  - MT25084_Part_C_memory.csv (server memory footprint per run, A1-A4)
 # ----------------------------
 
 if [[ "${EUID}" -ne 0 ]]; then
@@ -17,7 +21,7 @@ if [[ "${EUID}" -ne 0 ]]; then
   exit 1
 fi
 
-WORKDIR="$(cd "$(dirname "$0")" && pwd)"
+WORKDIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
 OWNER="${SUDO_USER:-root}"
 
 NS_SRV="ns_srv"
@@ -33,18 +37,92 @@ MSG_SIZES=(64 256 1024 4096 16384)
 # ✅ FIX: now >= 4 thread counts (only requested change)
 THREAD_COUNTS=(1 2 4 8)
 
-IMPLS=(A1 A2 A3)
+# A5 = AF_XDP raw frames over the same veth pair (needs one veth queue per thread)
+IMPLS=(A1 A2 A3 A4 A5)
+
+# block = normal blocking send/recv
+# busy  = MSG_DONTWAIT spin loops + SO_BUSY_POLL/SO_PREFER_BUSY_POLL on both sides
+#         (opt in with POLL_MODES=(block busy): doubles the grid and keeps a
+#         core spinning per connection)
+POLL_MODES=(block)
+BUSY_POLL_USEC=50
+
+# Mixed-size workloads (fixed = single msg_size, used by the main grid).
+# Specs use ':' so they stay a single CSV field. Mix runs use MIX_CAP as the
+# max message size and run in blocking mode only.
+MIX_DISTS=(bimodal:64:16384:0.9 lognormal:1024:1.0)
+MIX_CAP=16384
+
+# TCP_INFO + SIOCOUTQ/SIOCINQ sampling period on both sides (side thread), 0 = off.
+# Off by default: the sampler thread competes with the workers for CPU and
+# perturbs the headline numbers; opt in with e.g. TCPINFO_MS=100. The period is
+# recorded per run in the tcpinfo_ms column.
+TCPINFO_MS=0
+
+# veth queues per direction (1 = single-queue pair, all flows through one queue).
+# Opt in to multi-queue with e.g. VETH_QUEUES=$(nproc) RPS_XPS=1: TX queue q is
+# then used by (XPS) and RX queue q is processed on (RPS) the CPUs c with
+# c % queues == q, so a flow's sending CPU, its queue and the peer's softirq
+# CPU line up. A5 needs one queue per flow, so when A5 is in IMPLS the pair is
+# set up once, before the grid, with max(VETH_QUEUES, largest thread count)
+# queues and every impl runs on it. Every run records its queue count in the
+# queues column.
+VETH_QUEUES=1
+RPS_XPS=0
+CUR_QUEUES=0  # queues of the pair currently set up
+
+# 1 = --steer-cpu on both sides: each connection's worker runs on the CPU
+# reported by SO_INCOMING_CPU (see MT25084_Part_A_CpuSteer.h). Recorded in the
+# steer column.
+STEER_CPU=0
+
+# 1 = --lowmem on the A1-A4 servers: small fixed worker stacks and one shared
+# read-only payload (see MT25084_Part_A_MemAcct.h); 0 = default 8 MiB stacks
+# and a private payload per connection. The footprint is reported either way;
+# the lowmem column of the results says which model a run used.
+LOWMEM=0
+
+# A4 only: messages per batched sendmsg() (--batch-depth); "" = the server's default
+A4_BATCH_DEPTH=""
+
+# extra trailing args for both server and clients (Part E sets e.g. --sndbuf=...);
+# not passed to A5, which has no TCP data path
+EXTRA_OPTS=""
 
 # perf events (as per your perf list)
 EVENTS="cycles,context-switches,cache-misses,L1-dcache-load-misses,LLC-load-misses"
 
 RESULTS_CSV="MT25084_Part_C_results.csv"
-HEADER="impl,msg_size,threads,duration_s,total_bytes,total_msgs,total_gbps,weighted_avg_oneway_us,cycles,context_switches,cache_misses,L1_dcache_load_misses,LLC_load_misses"
+HEADER="impl,msg_size,threads,duration_s,total_bytes,total_msgs,total_gbps,weighted_avg_oneway_us,cycles,context_switches,cache_misses,L1_dcache_load_misses,LLC_load_misses,poll_mode,server_cpu_s,client_cpu_s,dist,copy_msgs,batch_msgs,zc_msgs,tcpinfo_ms,queues,steer,lowmem"
+
+BUCKETS_CSV="MT25084_Part_C_buckets.csv"
+BUCKETS_HEADER="impl,dist,msg_size,threads,duration_s,poll_mode,bucket_lo,bucket_hi,msgs,bytes,gbps"
+
+TCPINFO_CSV="MT25084_Part_C_tcpinfo.csv"
+TCPINFO_HEADER="impl,dist,msg_size,threads,duration_s,poll_mode,side,conn,t_s,rtt_us,rttvar_us,cwnd,ssthresh,snd_wnd,rcv_space,rcv_ssthresh,unacked,retrans,total_retrans,delivery_rate_Bps,busy_us,rwnd_limited_us,sndbuf_limited_us,notsent,outq,inq"
+
+MEMORY_CSV="MT25084_Part_C_memory.csv"
+MEMORY_HEADER="impl,dist,msg_size,threads,duration_s,poll_mode,mode,conns,rss_base_kib,rss_kib,stack_reserved_kib,stack_committed_kib,sock_mem_kib,tcp_mem_kib,payload_kib,rss_per_conn_b,stack_per_conn_b,sock_per_conn_b,payload_per_conn_b,bytes_per_conn"
 
 log() { echo "[C] $*"; }
 
+grid_queues() {
+  # -> veth queues for the whole grid: VETH_QUEUES, raised to the largest
+  # thread count if A5 (one queue per flow) is in IMPLS
+  local q="$VETH_QUEUES" impl tc
+  for impl in "${IMPLS[@]}"; do
+    [[ "$impl" == "A5" ]] || continue
+    for tc in "${THREAD_COUNTS[@]}"; do
+      if [[ "$tc" -gt "$q" ]]; then q="$tc"; fi
+    done
+  done
+  echo "$q"
+}
+
 setup_namespaces() {
-  log "Setting up namespaces..."
+  # args: [queues] (default grid_queues)
+  CUR_QUEUES="${1:-$(grid_queues)}"
+  log "Setting up namespaces (veth queues=${CUR_QUEUES}, rps/xps=${RPS_XPS})..."
 
   ip netns del "$NS_SRV" 2>/dev/null || true
   ip netns del "$NS_CLI" 2>/dev/null || true
@@ -53,7 +131,8 @@ setup_namespaces() {
   ip netns add "$NS_SRV"
   ip netns add "$NS_CLI"
 
-  ip link add veth_srv type veth peer name veth_cli
+  ip link add veth_srv numtxqueues "$CUR_QUEUES" numrxqueues "$CUR_QUEUES" type veth \
+    peer name veth_cli numtxqueues "$CUR_QUEUES" numrxqueues "$CUR_QUEUES"
   ip link set veth_srv netns "$NS_SRV"
   ip link set veth_cli netns "$NS_CLI"
 
@@ -65,9 +144,44 @@ setup_namespaces() {
   ip -n "$NS_SRV" link set veth_srv up
   ip -n "$NS_CLI" link set veth_cli up
 
+  if [[ "$RPS_XPS" -eq 1 ]]; then
+    configure_rps_xps "$NS_SRV" veth_srv
+    configure_rps_xps "$NS_CLI" veth_cli
+  fi
+
   ip netns exec "$NS_CLI" ping -c 1 "$SERVER_IP" >/dev/null
 }
 
+queue_cpu_mask() {
+  # args: queue -> sysfs cpumask (comma-separated 32-bit hex words) of the
+  # CPUs c with c % CUR_QUEUES == queue
+  local q="$1" ncpu c w
+  ncpu="$(nproc)"
+  local words=()
+  for ((w = 0; w <= (ncpu - 1) / 32; w++)); do words[w]=0; done
+  for ((c = q; c < ncpu; c += CUR_QUEUES)); do
+    words[c / 32]=$(( words[c / 32] | (1 << (c % 32)) ))
+  done
+  local mask=""
+  for ((w = ${#words[@]} - 1; w >= 0; w--)); do
+    mask+="$(printf '%08x' "${words[w]}")"
+    [[ "$w" -gt 0 ]] && mask+=","
+  done
+  echo "$mask"
+}
+
+configure_rps_xps() {
+  # args: netns dev
+  local ns="$1" dev="$2" q mask
+  for ((q = 0; q < CUR_QUEUES; q++)); do
+    mask="$(queue_cpu_mask "$q")"
+    ip netns exec "$ns" sh -c "echo $mask > /sys/class/net/$dev/queues/rx-$q/rps_cpus" 2>/dev/null \
+      || log "WARN: could not set RPS on $dev rx-$q"
+    ip netns exec "$ns" sh -c "echo $mask > /sys/class/net/$dev/queues/tx-$q/xps_cpus" 2>/dev/null \
+      || log "WARN: could not set XPS on $dev tx-$q"
+  done
+}
+
 compile_all() {
   log "Compiling all implementations..."
   cd "$WORKDIR"
@@ -75,14 +189,19 @@ compile_all() {
   rm -f MT25084_Part_A1_Server MT25084_Part_A1_Client \
         MT25084_Part_A2_Server MT25084_Part_A2_Client \
         MT25084_Part_A3_Server MT25084_Part_A3_Client \
-        *.o perf_*.txt MT25084_Part_C_raw_* MT25084_Part_C_results.csv 2>/dev/null || true
-
-  gcc -O2 -Wall -Wextra -pthread -o MT25084_Part_A1_Server MT25084_Part_A1_Server.c -pthread
-  gcc -O2 -Wall -Wextra -pthread -o MT25084_Part_A1_Client MT25084_Part_A1_Client.c -pthread
-  gcc -O2 -Wall -Wextra -pthread -o MT25084_Part_A2_Server MT25084_Part_A2_Server.c -pthread
-  gcc -O2 -Wall -Wextra -pthread -o MT25084_Part_A2_Client MT25084_Part_A2_Client.c -pthread
-  gcc -O2 -Wall -Wextra -pthread -o MT25084_Part_A3_Server MT25084_Part_A3_Server.c -pthread
-  gcc -O2 -Wall -Wextra -pthread -o MT25084_Part_A3_Client MT25084_Part_A3_Client.c -pthread
+        MT25084_Part_A4_Server \
+        MT25084_Part_A5_Server MT25084_Part_A5_Client \
+        *.o perf_*.txt MT25084_Part_C_raw_* MT25084_Part_C_results.csv MT25084_Part_C_buckets.csv MT25084_Part_C_tcpinfo.csv MT25084_Part_C_memory.csv 2>/dev/null || true
+
+  gcc -O2 -Wall -Wextra -pthread -o MT25084_Part_A1_Server MT25084_Part_A1_Server.c -pthread -lm
+  gcc -O2 -Wall -Wextra -pthread -o MT25084_Part_A1_Client MT25084_Part_A1_Client.c -pthread -lm
+  gcc -O2 -Wall -Wextra -pthread -o MT25084_Part_A2_Server MT25084_Part_A2_Server.c -pthread -lm
+  gcc -O2 -Wall -Wextra -pthread -o MT25084_Part_A2_Client MT25084_Part_A2_Client.c -pthread -lm
+  gcc -O2 -Wall -Wextra -pthread -o MT25084_Part_A3_Server MT25084_Part_A3_Server.c -pthread -lm
+  gcc -O2 -Wall -Wextra -pthread -o MT25084_Part_A3_Client MT25084_Part_A3_Client.c -pthread -lm
+  gcc -O2 -Wall -Wextra -pthread -o MT25084_Part_A4_Server MT25084_Part_A4_Server.c -pthread -lm
+  gcc -O2 -Wall -Wextra -pthread -o MT25084_Part_A5_Server MT25084_Part_A5_Server.c -pthread -lm
+  gcc -O2 -Wall -Wextra -pthread -o MT25084_Part_A5_Client MT25084_Part_A5_Client.c -pthread -lm
 }
 
 # ✅ FIXED: no gawk-only awk match() capture array
@@ -118,21 +237,105 @@ perf_get_val() {
 }
 
 parse_client_summary() {
-  # args: client_log
-  local f="$1"
+  # args: client_log [n] -> fields of the n-th SUMMARY line (default 1)
+  local f="$1" k="${2:-1}"
   local line
-  line="$(grep -m1 '^SUMMARY' "$f" 2>/dev/null || true)"
+  line="$({ grep '^SUMMARY' "$f" 2>/dev/null || true; } | sed -n "${k}p")"
   if [[ -z "$line" ]]; then
-    echo "0 0 0 0 0"
+    echo "0 0 0 0 0 0"
     return
   fi
-  local bytes secs gbps msgs avg
+  local bytes secs gbps msgs avg cpu
   bytes="$(echo "$line" | sed -n 's/.*bytes=\([0-9]\+\).*/\1/p')"
   secs="$(echo "$line"  | sed -n 's/.*seconds=\([0-9.]\+\).*/\1/p')"
   gbps="$(echo "$line"  | sed -n 's/.*gbps=\([0-9.]\+\).*/\1/p')"
   msgs="$(echo "$line"  | sed -n 's/.*msgs=\([0-9]\+\).*/\1/p')"
   avg="$(echo "$line"   | sed -n 's/.*avg_oneway_us=\([0-9.]\+\).*/\1/p')"
-  echo "${bytes:-0} ${secs:-0} ${gbps:-0} ${msgs:-0} ${avg:-0}"
+  cpu="$(echo "$line"   | sed -n 's/.* cpu_s=\([0-9.]\+\).*/\1/p')"  # not A5's flow_cpu_s
+  echo "${bytes:-0} ${secs:-0} ${gbps:-0} ${msgs:-0} ${avg:-0} ${cpu:-0}"
+}
+
+parse_server_summary() {
+  # args: server_log -> "cpu_s copy_msgs batch_msgs zc_msgs"
+  # (path counters are only printed by the A4 adaptive engine; 0 otherwise)
+  local f="$1"
+  local line
+  line="$(grep -m1 '^SERVER_SUMMARY' "$f" 2>/dev/null || true)"
+  local cpu copy batch zc
+  cpu="$(echo "$line"   | sed -n 's/.*cpu_s=\([0-9.]\+\).*/\1/p')"
+  copy="$(echo "$line"  | sed -n 's/.* copy_msgs=\([0-9]\+\).*/\1/p')"
+  batch="$(echo "$line" | sed -n 's/.* batch_msgs=\([0-9]\+\).*/\1/p')"
+  zc="$(echo "$line"    | sed -n 's/.* zc_msgs=\([0-9]\+\).*/\1/p')"
+  echo "${cpu:-0} ${copy:-0} ${batch:-0} ${zc:-0}"
+}
+
+poll_mode_opts() {
+  # args: poll_mode -> extra trailing args for server/client
+  case "$1" in
+    busy) echo "--busy-poll=${BUSY_POLL_USEC}" ;;
+    *)    echo "" ;;
+  esac
+}
+
+dist_opts() {
+  # args: dist -> extra trailing args for server/client
+  if [[ "$1" == "fixed" ]]; then
+    echo ""
+  else
+    echo "--dist=$1"
+  fi
+}
+
+aggregate_buckets() {
+  # args: row_prefix client_logs...
+  # sums BUCKET lines over all clients, one CSV row per bucket
+  local prefix="$1"
+  shift
+  { grep -h '^BUCKET' "$@" 2>/dev/null || true; } | awk -v p="$prefix" '
+    {
+      for (i = 2; i <= NF; i++) { split($i, kv, "="); v[kv[1]] = kv[2] }
+      k = v["lo"] "," v["hi"]
+      msgs[k] += v["msgs"]; bytes[k] += v["bytes"]; gbps[k] += v["gbps"]
+      lo[k] = v["lo"] + 0
+    }
+    END {
+      n = 0
+      for (k in lo) keys[++n] = k
+      for (i = 2; i <= n; i++) {   # sort by bucket_lo
+        x = keys[i]
+        for (j = i - 1; j >= 1 && lo[keys[j]] > lo[x]; j--) keys[j + 1] = keys[j]
+        keys[j + 1] = x
+      }
+      for (i = 1; i <= n; i++) {
+        k = keys[i]
+        printf "%s,%s,%.0f,%.0f,%.6f\n", p, k, msgs[k], bytes[k], gbps[k]
+      }
+    }
+  '
+}
+
+collect_kv_lines() {
+  # args: line_tag row_prefix logs...
+  # tagged lines are key=value in a fixed order; keep the values
+  local tag="$1" prefix="$2"
+  shift 2
+  { grep -h "^${tag} " "$@" 2>/dev/null || true; } | awk -v p="$prefix" '
+    {
+      row = p
+      for (i = 2; i <= NF; i++) { sub(/^[^=]*=/, "", $i); row = row "," $i }
+      print row
+    }
+  '
+}
+
+collect_tcpinfo() {
+  # args: row_prefix logs...
+  collect_kv_lines TCPINFO "$@"
+}
+
+collect_memory() {
+  # args: row_prefix server_log (MEM line, A1-A4 servers only)
+  collect_kv_lines MEM "$@"
 }
 
 run_one() {
@@ -140,26 +343,59 @@ run_one() {
   local msg="$2"
   local t="$3"
   local dur="$4"
+  local poll="$5"
+  local dist="${6:-fixed}"
+  local opts extra="$EXTRA_OPTS" tcpinfo_ms="$TCPINFO_MS"
+  if [[ "$impl" == "A5" ]]; then
+    # no TCP data path: A5 rejects --tcpinfo and the socket buffer options
+    extra=""
+    tcpinfo_ms=0
+  fi
+  opts="$(poll_mode_opts "$poll") $(dist_opts "$dist") ${extra}"
+  if [[ "$tcpinfo_ms" -gt 0 ]]; then
+    opts="${opts} --tcpinfo=${tcpinfo_ms}"
+  fi
+  if [[ "$STEER_CPU" -eq 1 ]]; then
+    opts="${opts} --steer-cpu"
+  fi
 
-  local tag="${impl}_m${msg}_t${t}_d${dur}"
+  local srv_opts="$opts" lowmem=0
+  if [[ "$LOWMEM" -eq 1 && "$impl" != "A5" ]]; then
+    srv_opts="${srv_opts} --lowmem"
+    lowmem=1
+  fi
+  if [[ "$impl" == "A4" && -n "$A4_BATCH_DEPTH" ]]; then
+    srv_opts="${srv_opts} --batch-depth=${A4_BATCH_DEPTH}"
+  fi
+
+  local tag="${impl}_m${msg}_t${t}_d${dur}_${poll}_${dist//[:\/]/-}"
   local perf_raw="MT25084_Part_C_raw_${tag}_perf.csv"
   local server_log="MT25084_Part_C_raw_${tag}_server.log"
 
   rm -f "$perf_raw" "$server_log" "MT25084_Part_C_raw_${tag}_client"*.log 2>/dev/null || true
 
+  local queues="$CUR_QUEUES"
+  if [[ "$impl" == "A5" && "$t" -gt "$queues" ]]; then
+    log "ERROR: A5 with ${t} flows needs ${t} veth queues, the pair has ${queues}"
+    return 1
+  fi
+
   kill_port_if_any
 
   local server_bin="./MT25084_Part_${impl}_Server"
   local client_bin="./MT25084_Part_${impl}_Client"
+  if [[ "$impl" == "A4" ]]; then
+    client_bin="./MT25084_Part_A1_Client"  # A4 only changes the sender; the receiver is A1's
+  fi
 
-  log "==> Running ${impl} msg=${msg} threads=${t} dur=${dur}s"
+  log "==> Running ${impl} msg=${msg} threads=${t} dur=${dur}s poll=${poll} dist=${dist}"
 
-  # IMPORTANT: server args = port msg_size duration num_clients
+  # IMPORTANT: server args = port msg_size duration num_clients [options]
   ip netns exec "$NS_SRV" bash -lc "
     cd '$WORKDIR' &&
     timeout -k 1s $((dur+3))s perf stat -x, --no-big-num \
       -e '$EVENTS' -o '$perf_raw' \
-      '$server_bin' '$PORT' '$msg' '$dur' '$t'
+      '$server_bin' '$PORT' '$msg' '$dur' '$t' $srv_opts
   " >"$server_log" 2>&1 &
   local srv_pid=$!
 
@@ -170,13 +406,20 @@ run_one() {
     return 1
   fi
 
-  # Run T clients in parallel
+  # Run T clients in parallel. A5 runs its T flows in one client process
+  # (one XDP program per interface), which prints one SUMMARY per flow.
+  local nclients="$t" cli_opts="$opts"
+  if [[ "$impl" == "A5" ]]; then
+    nclients=1
+    cli_opts="${opts} --flows=${t}"
+  fi
+
   local pids=()
   local i
-  for i in $(seq 1 "$t"); do
+  for i in $(seq 1 "$nclients"); do
     ip netns exec "$NS_CLI" bash -lc "
       cd '$WORKDIR' &&
-      '$client_bin' '$SERVER_IP' '$PORT' '$msg' '$dur'
+      '$client_bin' '$SERVER_IP' '$PORT' '$msg' '$dur' $cli_opts
     " >"MT25084_Part_C_raw_${tag}_client${i}.log" 2>&1 &
     pids+=("$!")
   done
@@ -194,16 +437,28 @@ run_one() {
   local total_msgs=0
   local total_gbps="0"
   local weighted_sum="0"
+  local client_cpu="0"
 
   for i in $(seq 1 "$t"); do
-    local f="MT25084_Part_C_raw_${tag}_client${i}.log"
-    read -r b s g m a < <(parse_client_summary "$f")
+    local f="MT25084_Part_C_raw_${tag}_client${i}.log" k=1
+    if [[ "$impl" == "A5" ]]; then
+      f="MT25084_Part_C_raw_${tag}_client1.log"
+      k="$i"
+    fi
+    read -r b s g m a c < <(parse_client_summary "$f" "$k")
 
     total_bytes=$((total_bytes + b))
     total_msgs=$((total_msgs + m))
     total_gbps="$(awk -v x="$total_gbps" -v y="$g" 'BEGIN{printf "%.6f", x+y}')"
     weighted_sum="$(awk -v ws="$weighted_sum" -v avg="$a" -v msgs="$m" 'BEGIN{printf "%.6f", ws + (avg*msgs)}')"
+    client_cpu="$(awk -v x="$client_cpu" -v y="$c" 'BEGIN{printf "%.6f", x+y}')"
   done
+  if [[ "$impl" == "A5" ]]; then
+    # one process for all flows: its CPU comes once, from CLIENT_SUMMARY
+    client_cpu="$({ grep -m1 '^CLIENT_SUMMARY' "MT25084_Part_C_raw_${tag}_client1.log" 2>/dev/null || true; } \
+      | sed -n 's/.* cpu_s=\([0-9.]\+\).*/\1/p')"
+    client_cpu="${client_cpu:-0}"
+  fi
 
   local wavg="0"
   if [[ "$total_msgs" -gt 0 ]]; then
@@ -218,7 +473,19 @@ run_one() {
   l1="$(perf_get_val "$perf_raw" "L1-dcache-load-misses" || true)"; l1="${l1:-0}"
   llc="$(perf_get_val "$perf_raw" "LLC-load-misses" || true)"; llc="${llc:-0}"
 
-  echo "${impl},${msg},${t},${dur},${total_bytes},${total_msgs},${total_gbps},${wavg},${cycles},${cs},${cachem},${l1},${llc}" >> "$RESULTS_CSV"
+  local server_cpu copy_msgs batch_msgs zc_msgs
+  read -r server_cpu copy_msgs batch_msgs zc_msgs < <(parse_server_summary "$server_log")
+
+  echo "${impl},${msg},${t},${dur},${total_bytes},${total_msgs},${total_gbps},${wavg},${cycles},${cs},${cachem},${l1},${llc},${poll},${server_cpu},${client_cpu},${dist},${copy_msgs},${batch_msgs},${zc_msgs},${tcpinfo_ms},${queues},${STEER_CPU},${lowmem}" >> "$RESULTS_CSV"
+
+  collect_tcpinfo "${impl},${dist},${msg},${t},${dur},${poll}" \
+    "$server_log" MT25084_Part_C_raw_"${tag}"_client*.log >> "$TCPINFO_CSV"
+  collect_memory "${impl},${dist},${msg},${t},${dur},${poll}" "$server_log" >> "$MEMORY_CSV"
+
+  if [[ "$dist" != "fixed" ]]; then
+    aggregate_buckets "${impl},${dist},${msg},${t},${dur},${poll}" \
+      MT25084_Part_C_raw_"${tag}"_client*.log >> "$BUCKETS_CSV"
+  fi
 }
 
 main() {
@@ -227,20 +494,38 @@ main() {
 
   cd "$WORKDIR"
   echo "$HEADER" > "$RESULTS_CSV"
-  chown "$OWNER":"$OWNER" "$RESULTS_CSV" 2>/dev/null || true
+  echo "$BUCKETS_HEADER" > "$BUCKETS_CSV"
+  echo "$TCPINFO_HEADER" > "$TCPINFO_CSV"
+  echo "$MEMORY_HEADER" > "$MEMORY_CSV"
+  chown "$OWNER":"$OWNER" "$RESULTS_CSV" "$BUCKETS_CSV" "$TCPINFO_CSV" "$MEMORY_CSV" 2>/dev/null || true
 
   log "Running experiment grid..."
-  local msg t impl
+  local msg t impl poll
   for msg in "${MSG_SIZES[@]}"; do
+    for t in "${THREAD_COUNTS[@]}"; do
+      for poll in "${POLL_MODES[@]}"; do
+        for impl in "${IMPLS[@]}"; do
+          run_one "$impl" "$msg" "$t" "$DUR" "$poll"
+        done
+      done
+    done
+  done
+
+  log "Running message-size mixes..."
+  local dist
+  for dist in "${MIX_DISTS[@]}"; do
     for t in "${THREAD_COUNTS[@]}"; do
       for impl in "${IMPLS[@]}"; do
-        run_one "$impl" "$msg" "$t" "$DUR"
+        run_one "$impl" "$MIX_CAP" "$t" "$DUR" block "$dist"
       done
     done
   done
 
-  log "Done. Results: $RESULTS_CSV"
+  log "Done. Results: $RESULTS_CSV (buckets: $BUCKETS_CSV, tcpinfo: $TCPINFO_CSV, memory: $MEMORY_CSV)"
 }
 
-main "$@"
-rm -f MT25084_Part_C_raw_* MT25084_Part_C_raw_*_perf.csv MT25084_Part_C_raw_*_server.log MT25084_Part_C_raw_*_client*.log 2>/dev/null || true
\ No newline at end of file
+# Part E sources this file for its helpers; only run the grid when executed
+if [[ "${BASH_SOURCE[0]}" == "$0" ]]; then
+  main "$@"
+  rm -f MT25084_Part_C_raw_* MT25084_Part_C_raw_*_perf.csv MT25084_Part_C_raw_*_server.log MT25084_Part_C_raw_*_client*.log 2>/dev/null || true
+fi
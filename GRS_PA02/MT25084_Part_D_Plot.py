@@ -7,6 +7,11 @@ import matplotlib.pyplot as plt
 DEFAULT_IN = "MT25084_Part_C_results.csv"
 OUT_DIR = "MT25084_Part_D_plots"
 DERIVED_OUT = "MT25084_Part_D_derived.csv"
+BUSY_POLL_OUT = "MT25084_Part_D_busy_poll_tradeoff.csv"
+ADAPTIVE_OUT = "MT25084_Part_D_adaptive_vs_fixed.csv"
+BUCKETS_IN = "MT25084_Part_C_buckets.csv"
+TCPINFO_IN = "MT25084_Part_C_tcpinfo.csv"
+TCPINFO_OUT = "MT25084_Part_D_tcpinfo_summary.csv"
 
 REQUIRED_COLS = [
     "impl", "msg_size", "threads", "duration_s",
@@ -19,8 +24,20 @@ OPTIONAL_COLS = [
     "cache_misses",
     "L1_dcache_load_misses",
     "LLC_load_misses",
+    "server_cpu_s",
+    "client_cpu_s",
+    "copy_msgs",
+    "batch_msgs",
+    "zc_msgs",
 ]
 
+# Part C columns that describe how a run was set up rather than what it measured;
+# rows only compare like with like when these match too
+RUN_SETUP_COLS = ["dist", "queues", "steer", "lowmem", "tcpinfo_ms"]
+
+def run_setup_cols(df):
+    return [c for c in RUN_SETUP_COLS if c in df.columns]
+
 def ensure_numeric(df, cols):
     for c in cols:
         if c in df.columns:
@@ -46,7 +63,7 @@ def plot_metric(df, metric_col, ylabel, title_prefix, out_basename):
         return
 
     threads_list = sorted(df["threads"].dropna().unique())
-    impls = sorted(df["impl"].dropna().unique())
+    impls = sorted(df["series"].dropna().unique())
     msg_sizes = sorted(df["msg_size"].dropna().unique())
 
     for t in threads_list:
@@ -57,7 +74,7 @@ def plot_metric(df, metric_col, ylabel, title_prefix, out_basename):
 
         plotted_any = False
         for impl in impls:
-            dfi = dft[dft["impl"] == impl].sort_values("msg_size")
+            dfi = dft[dft["series"] == impl].sort_values("msg_size")
             if len(dfi) == 0:
                 continue
             ax.plot(dfi["msg_size"], dfi[metric_col], marker="o", label=str(impl))
@@ -77,6 +94,145 @@ def plot_metric(df, metric_col, ylabel, title_prefix, out_basename):
         out_png = os.path.join(OUT_DIR, f"{out_basename}_t{int(t)}.png")
         save_plot(fig, out_png)
 
+def plot_mix(df):
+    # one bar group per size mix, one bar per engine
+    mix = df[df["dist"] != "fixed"]
+    if len(mix) == 0:
+        return
+    dists = sorted(mix["dist"].unique())
+    impls = sorted(mix["series"].unique())
+    width = 0.8 / max(len(impls), 1)
+
+    for t in sorted(mix["threads"].dropna().unique()):
+        dft = mix[mix["threads"] == t]
+        fig = plt.figure()
+        ax = fig.add_subplot(111)
+        for j, impl in enumerate(impls):
+            vals = [dft[(dft["dist"] == d) & (dft["series"] == impl)]["total_gbps"].sum() for d in dists]
+            ax.bar([i + j * width for i in range(len(dists))], vals, width, label=str(impl))
+        ax.set_xticks([i + 0.4 - width / 2 for i in range(len(dists))])
+        ax.set_xticklabels(dists, rotation=15, fontsize=8)
+        ax.set_ylabel("Throughput (Gbps)")
+        ax.set_title(f"Throughput under message-size mixes (threads={int(t)})")
+        ax.grid(True, axis="y", linestyle="--", linewidth=0.5, alpha=0.6)
+        ax.legend()
+        save_plot(fig, os.path.join(OUT_DIR, f"mix_throughput_gbps_t{int(t)}.png"))
+
+def plot_buckets(buckets_csv):
+    # per-size-bucket throughput of the mix runs, one figure per (dist, threads)
+    if not os.path.exists(buckets_csv):
+        return
+    b = pd.read_csv(buckets_csv)
+    if len(b) == 0:
+        return
+    b = ensure_numeric(b, ["threads", "bucket_lo", "bucket_hi", "msgs", "bytes", "gbps"])
+
+    for (dist, t), g in b.groupby(["dist", "threads"]):
+        fig = plt.figure()
+        ax = fig.add_subplot(111)
+        for impl in sorted(g["impl"].unique()):
+            gi = g[g["impl"] == impl].sort_values("bucket_hi")
+            ax.plot(gi["bucket_hi"], gi["gbps"], marker="o", label=str(impl))
+        set_log2_x(ax)
+        ax.get_xaxis().set_major_formatter(plt.FuncFormatter(lambda v, _: f"{int(v)}"))
+        ax.set_xlabel("Message size bucket upper bound (bytes) [log2 scale]")
+        ax.set_ylabel("Throughput in bucket (Gbps)")
+        ax.set_title(f"Per-bucket throughput, {dist} (threads={int(t)})", fontsize=9)
+        ax.grid(True, which="both", linestyle="--", linewidth=0.5, alpha=0.6)
+        ax.legend()
+        safe = "".join(c if c.isalnum() else "-" for c in str(dist))
+        save_plot(fig, os.path.join(OUT_DIR, f"bucket_gbps_{safe}_t{int(t)}.png"))
+
+def write_tcpinfo_summary(tcpinfo_csv):
+    # One row per (run, side): transport state averaged over the run, plus how
+    # much of the sender's busy time TCP itself spent window/buffer limited.
+    if not os.path.exists(tcpinfo_csv):
+        return
+    ti = pd.read_csv(tcpinfo_csv)
+    if len(ti) == 0:
+        return
+    run_key = ["impl", "dist", "msg_size", "threads", "duration_s", "poll_mode", "side"]
+    num = [c for c in ti.columns if c not in run_key]
+    ti = ensure_numeric(ti, num)
+
+    # busy/limited/retrans counters are cumulative: take each connection's last sample
+    last = ti.sort_values("t_s").groupby(run_key + ["conn"]).tail(1)
+    per_run = last.groupby(run_key)[["busy_us", "rwnd_limited_us", "sndbuf_limited_us", "total_retrans"]].sum()
+    busy = per_run["busy_us"].replace(0, float("nan"))
+    per_run["rwnd_limited_frac"] = per_run["rwnd_limited_us"] / busy
+    per_run["sndbuf_limited_frac"] = per_run["sndbuf_limited_us"] / busy
+
+    means = ti.groupby(run_key)[["rtt_us", "cwnd", "snd_wnd", "rcv_space", "unacked",
+                                 "delivery_rate_Bps", "outq", "inq"]].mean().add_prefix("mean_")
+    out = means.join(per_run).reset_index()
+
+    # coarse verdict for the sender side; receivers only contribute rcv_space/inq
+    def verdict(row):
+        if row["side"] != "srv":
+            return ""
+        if row["rwnd_limited_frac"] >= 0.5:
+            return "receiver_window"
+        if row["sndbuf_limited_frac"] >= 0.5:
+            return "send_buffer"
+        if row["total_retrans"] >= row["duration_s"]:  # >= 1 retransmit/s
+            return "loss"
+        return "app_or_cpu"
+    out["bottleneck"] = out.apply(verdict, axis=1)
+
+    out.sort_values(run_key).to_csv(TCPINFO_OUT, index=False)
+    print(f"[ok] wrote: {TCPINFO_OUT}")
+
+def write_busy_poll_tradeoff(df):
+    # Pair each busy-poll run with its blocking twin: latency gained vs CPU burned
+    if "cpu_cores_used" not in df.columns:
+        return
+    key = ["impl", "msg_size", "threads"] + run_setup_cols(df)
+    block = df[df["poll_mode"] == "block"]
+    busy = df[df["poll_mode"] == "busy"]
+    if len(block) == 0 or len(busy) == 0:
+        return
+
+    m = block.merge(busy, on=key, suffixes=("_block", "_busy"))
+    out = m[key].copy()
+    out["latency_block_us"] = m["weighted_avg_oneway_us_block"]
+    out["latency_busy_us"] = m["weighted_avg_oneway_us_busy"]
+    out["latency_gain_us"] = out["latency_block_us"] - out["latency_busy_us"]
+    out["gbps_block"] = m["total_gbps_block"]
+    out["gbps_busy"] = m["total_gbps_busy"]
+    out["cores_block"] = m["cpu_cores_used_block"]
+    out["cores_busy"] = m["cpu_cores_used_busy"]
+    out["extra_cores"] = out["cores_busy"] - out["cores_block"]
+    # > 0 means busy polling bought latency; per extra core burned
+    out["latency_gain_us_per_extra_core"] = out["latency_gain_us"] / out["extra_cores"].replace(0, float("nan"))
+    out.sort_values(key).to_csv(BUSY_POLL_OUT, index=False)
+    print(f"[ok] wrote: {BUSY_POLL_OUT}")
+
+def write_adaptive_vs_fixed(df):
+    # A4 acceptance check: on every message-size mix, the adaptive engine must
+    # be at least as fast as the best fixed engine (A1/A2/A3) of the same run point
+    key = ["dist", "msg_size", "threads", "poll_mode"] + [c for c in run_setup_cols(df) if c != "dist"]
+    mix = df[df["dist"] != "fixed"]
+    fixed_eng = mix[mix["impl"].isin(["A1", "A2", "A3"])]
+    a4 = mix[mix["impl"] == "A4"]
+    if len(fixed_eng) == 0 or len(a4) == 0:
+        return
+
+    best = fixed_eng.loc[fixed_eng.groupby(key)["total_gbps"].idxmax(), key + ["impl", "total_gbps"]]
+    best = best.rename(columns={"impl": "best_fixed_impl", "total_gbps": "best_fixed_gbps"})
+    out = a4[key + ["total_gbps"]].rename(columns={"total_gbps": "a4_gbps"}).merge(best, on=key)
+    out["a4_vs_best_pct"] = (out["a4_gbps"] - out["best_fixed_gbps"]) * 100 / out["best_fixed_gbps"].replace(0, float("nan"))
+    out["never_slower"] = out["a4_gbps"] >= out["best_fixed_gbps"]
+    out.sort_values(key).to_csv(ADAPTIVE_OUT, index=False)
+    print(f"[ok] wrote: {ADAPTIVE_OUT}")
+
+    slower = out[~out["never_slower"]]
+    if len(slower) > 0:
+        print(f"[warn] A4 slower than the best fixed engine on {len(slower)} of {len(out)} mix points:")
+        for _, r in slower.iterrows():
+            print(f"       {r['dist']} threads={int(r['threads'])} {r['poll_mode']}: "
+                  f"A4 {r['a4_gbps']:.3f} vs {r['best_fixed_impl']} {r['best_fixed_gbps']:.3f} Gbps "
+                  f"({r['a4_vs_best_pct']:+.1f}%)")
+
 def main():
     in_csv = sys.argv[1] if len(sys.argv) > 1 else DEFAULT_IN
     if not os.path.exists(in_csv):
@@ -97,10 +253,13 @@ def main():
     df.loc[df["impl"].isin(["nan", "None"]), "impl"] = ""
 
     if df["impl"].eq("").all():
-        # C runs A1 -> A2 -> A3 for each (msg_size, threads, duration_s)
+        # C runs A1 -> A2 -> A3 -> A4 -> A5 for each (msg_size, threads, duration_s)
         grp = ["msg_size", "threads", "duration_s"]
+        for c in ("poll_mode", "dist"):
+            if c in df.columns:
+                grp.append(c)
         df["__k"] = df.groupby(grp).cumcount()
-        mapping = {0: "A1", 1: "A2", 2: "A3"}
+        mapping = {0: "A1", 1: "A2", 2: "A3", 3: "A4", 4: "A5"}
         df["impl"] = df["__k"].map(mapping).fillna("A?")
         df.drop(columns=["__k"], inplace=True)
 
@@ -108,6 +267,20 @@ def main():
     numeric_cols = [c for c in (REQUIRED_COLS + OPTIONAL_COLS) if c != "impl"]
     df = ensure_numeric(df, numeric_cols)
 
+    # older CSVs (before busy-poll mode) are all blocking runs
+    if "poll_mode" not in df.columns:
+        df["poll_mode"] = "block"
+    df["poll_mode"] = df["poll_mode"].fillna("block").astype(str).str.strip()
+
+    # ... and single fixed-size runs
+    if "dist" not in df.columns:
+        df["dist"] = "fixed"
+    df["dist"] = df["dist"].fillna("fixed").astype(str).str.strip()
+
+    # plot line label: impl, suffixed with the run variant when not the default
+    df["series"] = df["impl"]
+    df.loc[df["poll_mode"] != "block", "series"] = df["impl"] + "+" + df["poll_mode"]
+
     # Derived metrics
     df["cycles_per_byte"] = df["cycles"] / df["total_bytes"].replace(0, float("nan"))
     df["ctx_switches_per_sec"] = df["context_switches"] / df["duration_s"].replace(0, float("nan"))
@@ -127,21 +300,39 @@ def main():
     if "cache_references" in df.columns and "cache_misses" in df.columns:
         df["cache_miss_rate"] = df["cache_misses"] / df["cache_references"].replace(0, float("nan"))
 
+    if "server_cpu_s" in df.columns and "client_cpu_s" in df.columns:
+        # cores kept busy on average by server + all clients
+        df["cpu_cores_used"] = (df["server_cpu_s"] + df["client_cpu_s"]) / df["duration_s"].replace(0, float("nan"))
+
+    if {"copy_msgs", "batch_msgs", "zc_msgs"} <= set(df.columns):
+        # A4 adaptive engine: share of messages each send path carried
+        routed = (df["copy_msgs"] + df["batch_msgs"] + df["zc_msgs"]).replace(0, float("nan"))
+        for c in ("copy", "batch", "zc"):
+            df[f"{c}_share"] = df[f"{c}_msgs"] / routed
+
     out_cols_candidate = [
-        "impl","msg_size","threads","duration_s","total_bytes","total_msgs","total_gbps","weighted_avg_oneway_us",
+        "impl","poll_mode","dist","msg_size","threads","duration_s","total_bytes","total_msgs","total_gbps","weighted_avg_oneway_us",
         "cycles","context_switches",
         "cycles_per_byte","ctx_switches_per_sec",
         "cache_references","cache_misses","cache_miss_rate",
         "L1_dcache_load_misses","LLC_load_misses",
         "cache_misses_per_gb","cache_misses_per_mmsg",
         "L1_misses_per_gb","L1_misses_per_mmsg",
-        "LLC_misses_per_gb","LLC_misses_per_mmsg"
+        "LLC_misses_per_gb","LLC_misses_per_mmsg",
+        "server_cpu_s","client_cpu_s","cpu_cores_used",
+        "copy_msgs","batch_msgs","zc_msgs","copy_share","batch_share","zc_share"
     ]
     df_out_cols = [c for c in out_cols_candidate if c in df.columns]
     df[df_out_cols].to_csv(DERIVED_OUT, index=False)
     print(f"[ok] wrote: {DERIVED_OUT}")
 
-    # Plots
+    write_busy_poll_tradeoff(df)
+    write_adaptive_vs_fixed(df)
+    write_tcpinfo_summary(os.path.join(os.path.dirname(os.path.abspath(in_csv)), TCPINFO_IN))
+
+    # Plots (size sweeps use the fixed-size runs; mixes get their own figures)
+    mix_df = df
+    df = df[df["dist"] == "fixed"]
     plot_metric(df, "total_gbps", "Throughput (Gbps)", "Throughput vs Message Size", "throughput_gbps")
     plot_metric(df, "weighted_avg_oneway_us", "Weighted avg one-way latency (us)", "Latency vs Message Size", "latency_us")
     plot_metric(df, "cycles_per_byte", "Cycles / byte", "CPU Cost vs Message Size", "cycles_per_byte")
@@ -153,6 +344,11 @@ def main():
         plot_metric(df, "L1_misses_per_gb", "L1D load misses per GiB transferred", "L1D Misses vs Message Size", "l1_misses_per_gb")
     if "LLC_misses_per_gb" in df.columns:
         plot_metric(df, "LLC_misses_per_gb", "LLC load misses per GiB transferred", "LLC Misses vs Message Size", "llc_misses_per_gb")
+    if "cpu_cores_used" in df.columns:
+        plot_metric(df, "cpu_cores_used", "CPU cores used (server + clients)", "CPU Burned vs Message Size", "cpu_cores_used")
+
+    plot_mix(mix_df)
+    plot_buckets(os.path.join(os.path.dirname(os.path.abspath(in_csv)), BUCKETS_IN))
 
     print(f"[ok] plots in: {OUT_DIR}/ (png + pdf)")
 
@@ -0,0 +1,234 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# ----------------------------
+# MT25084 Part E Auto-Tuner
+# ----------------------------
+# For every workload point (message size x connection count) searches the
+# configuration space (engine x poll mode x socket buffers x A4 batch depth x
+# CPU steering) with successive
+# halving: every surviving config gets a short trial run, the better half
+# survives and the trial length doubles. The winner and the A1 baseline are
+# then confirmed with full-length repeated runs.
+# Reuses the namespace setup and run_one() of Part C (sourced, not executed).
+# Produces:
+#  - MT25084_Part_E_trials.csv       every trial run of the search
+#  - MT25084_Part_E_best_configs.csv best configuration per workload point,
+#                                    with the flags to deploy it
+# ----------------------------
+
+# shellcheck source=MT25084_Part_C_Run_Experiments.sh
+source "$(cd "$(dirname "$0")" && pwd)/MT25084_Part_C_Run_Experiments.sh"
+
+# workload points to tune
+TUNE_MSG_SIZES=(64 1024 16384)
+TUNE_THREAD_COUNTS=(1 4 8)
+
+# search space
+TUNE_IMPLS=(A1 A2 A3 A4)              # A5 (AF_XDP) is a floor reference, not a deployable TCP config
+TUNE_POLLS=(block busy:20 busy:50)   # busy:<usec> = --busy-poll=<usec>
+TUNE_SOCKBUFS=(auto 262144 4194304)  # auto = kernel autotuning, else --sndbuf/--rcvbuf
+TUNE_BATCH=(4 8 16)                  # A4 --batch-depth (server only); "-" for the other engines
+TUNE_STEER=(0 1)                     # 1 = --steer-cpu on both sides
+
+BASELINE_CFG="A1/block/auto/-/0"
+
+# gbps = maximize total_gbps, latency = minimize weighted_avg_oneway_us
+OBJECTIVE=gbps
+
+TRIAL_DUR=2        # first halving round (s); doubles each round, capped at CONFIRM_DUR
+CONFIRM_DUR=10
+CONFIRM_REPEATS=3
+
+TRIALS_CSV="MT25084_Part_E_trials.csv"
+TRIALS_HEADER="msg_size,threads,round,duration_s,impl,poll,sockbuf,batch,steer,gbps,latency_us,score"
+BEST_CSV="MT25084_Part_E_best_configs.csv"
+BEST_HEADER="msg_size,threads,impl,poll,sockbuf,batch,steer,mean_gbps,stddev_gbps,mean_latency_us,baseline_gbps,baseline_latency_us,gain_pct,objective,flags,server_flags"
+
+# Part C's run_one() appends to these; keep tuner runs out of the Part C outputs
+RESULTS_CSV="MT25084_Part_E_raw_runs.csv"
+BUCKETS_CSV="/dev/null"
+TCPINFO_CSV="/dev/null"
+MEMORY_CSV="/dev/null"
+TCPINFO_MS=0
+
+elog() { echo "[E] $*" >&2; }
+
+cfg_flags() {
+  # args: cfg -> trailing args for server and clients
+  local impl poll buf batch steer flags=""
+  IFS=/ read -r impl poll buf batch steer <<< "$1"
+  if [[ "$poll" == busy:* ]]; then
+    flags="--busy-poll=${poll#busy:}"
+  fi
+  if [[ "$buf" != "auto" ]]; then
+    flags="${flags:+$flags }--sndbuf=${buf} --rcvbuf=${buf}"
+  fi
+  if [[ "$steer" -eq 1 ]]; then
+    flags="${flags:+$flags }--steer-cpu"
+  fi
+  echo "$flags"
+}
+
+cfg_server_flags() {
+  # args: cfg -> extra trailing args for the server only
+  local impl poll buf batch steer
+  IFS=/ read -r impl poll buf batch steer <<< "$1"
+  if [[ "$batch" != "-" ]]; then
+    echo "--batch-depth=${batch}"
+  fi
+}
+
+run_config() {
+  # args: cfg msg threads dur -> "gbps latency_us" (0 0 if the run failed)
+  local cfg="$1" msg="$2" t="$3" dur="$4"
+  local impl poll buf batch steer mode="block"
+  IFS=/ read -r impl poll buf batch steer <<< "$cfg"
+
+  # poll mode goes through run_one's own poll argument, buffers via EXTRA_OPTS
+  if [[ "$poll" == busy:* ]]; then
+    mode="busy"
+    BUSY_POLL_USEC="${poll#busy:}"
+  fi
+  EXTRA_OPTS=""
+  if [[ "$buf" != "auto" ]]; then
+    EXTRA_OPTS="--sndbuf=${buf} --rcvbuf=${buf}"
+  fi
+  STEER_CPU="$steer"
+  A4_BATCH_DEPTH=""
+  if [[ "$batch" != "-" ]]; then
+    A4_BATCH_DEPTH="$batch"
+  fi
+
+  # a run that moved no data (server gone before clients connected, etc.) is
+  # retried once so a transient failure does not eliminate a good config
+  local attempt before after res="0 0"
+  for attempt in 1 2; do
+    before="$(wc -l < "$RESULTS_CSV")"
+    run_one "$impl" "$msg" "$t" "$dur" "$mode" >&2 || true
+    after="$(wc -l < "$RESULTS_CSV")"
+    if [[ "$after" -gt "$before" ]]; then
+      res="$(tail -n 1 "$RESULTS_CSV" | awk -F',' '{print $7, $8}')"
+    fi
+    if awk -v g="${res%% *}" 'BEGIN{ exit !(g > 0) }'; then
+      break
+    fi
+    elog "retrying ${cfg} (attempt ${attempt} moved no data)"
+  done
+  echo "$res"
+}
+
+score() {
+  # args: gbps latency_us -> higher is better
+  if [[ "$OBJECTIVE" == "latency" ]]; then
+    awk -v l="$2" 'BEGIN{ if (l > 0) printf "%.6f", -l; else print "-1e18" }'
+  else
+    echo "$1"
+  fi
+}
+
+confirm() {
+  # args: cfg msg threads -> "mean_gbps stddev_gbps mean_latency_us"
+  local cfg="$1" msg="$2" t="$3"
+  local runs="" i g l
+  for i in $(seq 1 "$CONFIRM_REPEATS"); do
+    read -r g l < <(run_config "$cfg" "$msg" "$t" "$CONFIRM_DUR")
+    runs+="${g} ${l}"$'\n'
+  done
+  printf '%s' "$runs" | awk '
+    { n++; s += $1; ss += $1 * $1; lat += $2 }
+    END {
+      m = s / n; v = ss / n - m * m; if (v < 0) v = 0
+      printf "%.6f %.6f %.6f\n", m, sqrt(v), lat / n
+    }
+  '
+}
+
+tune_point() {
+  # args: msg threads
+  local msg="$1" t="$2"
+  local cands=() impl poll buf batch steer batches
+  for impl in "${TUNE_IMPLS[@]}"; do
+    batches=("-")
+    if [[ "$impl" == "A4" ]]; then
+      batches=("${TUNE_BATCH[@]}")
+    fi
+    for poll in "${TUNE_POLLS[@]}"; do
+      for buf in "${TUNE_SOCKBUFS[@]}"; do
+        for batch in "${batches[@]}"; do
+          for steer in "${TUNE_STEER[@]}"; do
+            cands+=("${impl}/${poll}/${buf}/${batch}/${steer}")
+          done
+        done
+      done
+    done
+  done
+
+  local round=0 dur="$TRIAL_DUR"
+  while [[ "${#cands[@]}" -gt 1 ]]; do
+    elog "msg=${msg} threads=${t} round=${round}: ${#cands[@]} configs x ${dur}s"
+    local scored="" cfg g l sc
+    for cfg in "${cands[@]}"; do
+      read -r g l < <(run_config "$cfg" "$msg" "$t" "$dur")
+      sc="$(score "$g" "$l")"
+      echo "${msg},${t},${round},${dur},${cfg//\//,},${g},${l},${sc}" >> "$TRIALS_CSV"
+      scored+="${sc} ${cfg}"$'\n'
+    done
+
+    # keep the better half (rounded up)
+    local keep=$(( (${#cands[@]} + 1) / 2 ))
+    mapfile -t cands < <(printf '%s' "$scored" | sort -s -g -r -k1,1 | head -n "$keep" | awk '{print $2}')
+
+    round=$((round + 1))
+    dur=$((dur * 2))
+    if [[ "$dur" -gt "$CONFIRM_DUR" ]]; then
+      dur="$CONFIRM_DUR"
+    fi
+  done
+
+  local winner="${cands[0]}"
+  elog "msg=${msg} threads=${t}: confirming ${winner} vs baseline ${BASELINE_CFG}"
+
+  local wg wsd wl bg bsd bl
+  read -r wg wsd wl < <(confirm "$winner" "$msg" "$t")
+  if [[ "$winner" == "$BASELINE_CFG" ]]; then
+    bg="$wg"; bsd="$wsd"; bl="$wl"
+  else
+    read -r bg bsd bl < <(confirm "$BASELINE_CFG" "$msg" "$t")
+  fi
+
+  # gain in the objective over the baseline, positive = better: more Gbps, or
+  # lower latency
+  local gain
+  if [[ "$OBJECTIVE" == "latency" ]]; then
+    gain="$(awk -v w="$wl" -v b="$bl" 'BEGIN{ if (b > 0) printf "%.2f", (b - w) * 100 / b; else print "0" }')"
+  else
+    gain="$(awk -v w="$wg" -v b="$bg" 'BEGIN{ if (b > 0) printf "%.2f", (w - b) * 100 / b; else print "0" }')"
+  fi
+  echo "${msg},${t},${winner//\//,},${wg},${wsd},${wl},${bg},${bl},${gain},${OBJECTIVE},$(cfg_flags "$winner"),$(cfg_server_flags "$winner")" >> "$BEST_CSV"
+}
+
+tune_main() {
+  setup_namespaces "$VETH_QUEUES"  # no A5 in the search
+
+  cd "$WORKDIR"
+  elog "Building..."
+  make >/dev/null
+
+  echo "$HEADER" > "$RESULTS_CSV"
+  echo "$TRIALS_HEADER" > "$TRIALS_CSV"
+  echo "$BEST_HEADER" > "$BEST_CSV"
+  chown "$OWNER":"$OWNER" "$TRIALS_CSV" "$BEST_CSV" 2>/dev/null || true
+
+  local msg t
+  for msg in "${TUNE_MSG_SIZES[@]}"; do
+    for t in "${TUNE_THREAD_COUNTS[@]}"; do
+      tune_point "$msg" "$t"
+    done
+  done
+
+  rm -f "$RESULTS_CSV" MT25084_Part_C_raw_* 2>/dev/null || true
+  elog "Done. Best configs: $BEST_CSV (all trials: $TRIALS_CSV)"
+}
+
+tune_main "$@"